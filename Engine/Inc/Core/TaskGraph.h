@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace VE::Core {
+
+using TaskId = uint32_t;
+
+struct TaskTiming {
+    std::string name;
+    uint32_t thread = 0;            // 0 is the thread that called Run
+    double startMs = 0.0;           // Relative to the start of Run
+    double durationMs = 0.0;
+};
+
+/**
+ * Runs dependent tasks on a pool of threads
+ *
+ * A task starts as soon as all of its dependencies have finished. Tasks flagged mainThread, such
+ * as window system calls, are run by the thread calling Run. When a task throws, no further tasks
+ * are started and the exception is rethrown from Run once the running tasks have returned.
+ */
+class TaskGraph {
+public:
+    using TaskFunc = std::function<void()>;
+
+    // Dependencies must have been added before, which rules out cycles
+    TaskId Add(std::string name, TaskFunc func, std::vector<TaskId> dependencies = {}, bool mainThread = false);
+
+    // A threadCount of 0 uses one worker per hardware thread
+    void Run(uint32_t threadCount = 0);
+
+    [[nodiscard]] const std::vector<TaskTiming>& GetTimings() const { return mTimings; }
+
+    // One line per task in start order, followed by the wall and summed task times
+    [[nodiscard]] static std::string Report(const std::vector<TaskTiming>& timings);
+
+private:
+    struct Task {
+        std::string name;
+        TaskFunc func;
+        std::vector<TaskId> dependants;
+        uint32_t dependencyCount = 0;
+        bool mainThread = false;
+    };
+
+private:
+    std::vector<Task> mTasks;
+    std::vector<TaskTiming> mTimings;
+};
+
+}
\ No newline at end of file
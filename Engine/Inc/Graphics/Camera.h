@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace VE::Gfx {
+
+struct Camera {
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    float fovY = glm::radians(60.0f);
+    float zNear = 0.1f;
+    float zFar = 100.0f;
+
+    // Vulkan clip space, y points down and depth is in [0, 1]
+    [[nodiscard]] glm::mat4 GetProjection(float aspect) const {
+        glm::mat4 proj = glm::perspective(fovY, aspect, zNear, zFar);
+        proj[1][1] *= -1.0f;
+        return proj;
+    }
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include <Graphics/Camera.h>
+#include <Graphics/ComputePass.h>
+#include <Graphics/PipelineLibrary.h>
+#include <Graphics/ResidencyManager.h>
+
+namespace VE::Gfx {
+
+constexpr uint32_t CLUSTER_GRID_X = 16;
+constexpr uint32_t CLUSTER_GRID_Y = 9;
+constexpr uint32_t CLUSTER_GRID_Z = 24;
+constexpr uint32_t CLUSTER_COUNT = CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+
+constexpr uint32_t MAX_LIGHTS = 4096;
+constexpr uint32_t MAX_LIGHT_INDICES = CLUSTER_COUNT * 128;
+
+enum class LightType : uint32_t {
+    Point = 0,
+    Spot = 1
+};
+
+// Matches the std430 layout of Light in clustered_common.slang
+struct Light {
+    glm::vec3 position = glm::vec3(0.0f);
+    float range = 1.0f;
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+    glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    float spotInnerCos = 1.0f;
+    float spotOuterCos = 0.0f;
+    LightType type = LightType::Point;
+    float padding[2] = {};
+};
+static_assert(sizeof(Light) == 64);
+
+/**
+ * Clustered forward lighting
+ *
+ * A compute pass bins the lights into a 3D froxel grid (screen tiles by exponential depth
+ * slices) every frame. Each cluster gets a compact range in a shared light index list, so the
+ * fragment shader only evaluates the lights overlapping its cluster. The grid and index list
+ * are streamable buffers and are bound to the graphics pipeline through GetDescriptorSet.
+ */
+class ClusteredLighting {
+public:
+    ClusteredLighting(
+        const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice,
+        const vk::raii::Queue& queue, uint32_t queueFamilyIndex, const PipelineLibrary& pipelines,
+        ResidencyManager& residency
+    );
+    ~ClusteredLighting();
+
+    void SetLights(std::span<const Light> lights);
+
+    // Uploads the camera and lights for the frame, its previous use must have completed. Called after
+    // the residency manager's update, so descriptors follow buffers it moved.
+    void Update(uint32_t frameIndex, const Camera& camera, vk::Extent2D renderExtent);
+
+    // Records light binning, must be recorded before any fragment shading that reads the clusters
+    void RecordCulling(const vk::raii::CommandBuffer& cmd, uint32_t frameIndex) const;
+
+    [[nodiscard]] vk::DescriptorSetLayout GetDescriptorSetLayout() const { return *mDescriptorSetLayout; }
+    [[nodiscard]] vk::DescriptorSet GetDescriptorSet(uint32_t frameIndex) const { return *mDescriptorSets[frameIndex]; }
+
+private:
+    struct FrameResources {
+        vk::raii::Buffer frameData = nullptr;
+        vk::raii::DeviceMemory frameDataMemory = nullptr;
+        void* frameDataMapped = nullptr;
+
+        vk::raii::Buffer lights = nullptr;
+        vk::raii::DeviceMemory lightsMemory = nullptr;
+        void* lightsMapped = nullptr;
+
+        StreamableBufferHandle lightGrid = 0;
+        StreamableBufferHandle lightIndices = 0;
+
+        // Where the streamable buffers lived when the descriptors were last written
+        vk::Buffer boundLightGrid;
+        vk::Buffer boundLightIndices;
+    };
+
+    void createBuffers();
+    void createDescriptorSets();
+    void writeDescriptorSets(uint32_t frameIndex);
+
+private:
+    const vk::raii::Device& mDevice;
+    const vk::raii::PhysicalDevice& mPhysicalDevice;
+    ResidencyManager& mResidency;
+
+    std::vector<Light> mLights;
+    std::vector<FrameResources> mFrames;
+
+    std::unique_ptr<ComputePass> mCullPass;
+
+    // Read-only view of the same buffers for the graphics pipeline
+    vk::raii::DescriptorSetLayout mDescriptorSetLayout = nullptr;
+    vk::raii::DescriptorPool mDescriptorPool = nullptr;
+    std::vector<vk::raii::DescriptorSet> mDescriptorSets;
+};
+
+}
\ No newline at end of file
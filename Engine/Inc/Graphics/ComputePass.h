@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan_raii.hpp>
+
+namespace VE::Gfx {
+
+struct ComputePassDesc {
+    std::vector<char> code;
+    const char* entryPoint = "compMain";
+    std::vector<vk::DescriptorSetLayoutBinding> bindings;
+    uint32_t pushConstantSize = 0;
+    const vk::raii::PipelineCache* pipelineCache = nullptr;
+};
+
+/**
+ * A compute pipeline with one descriptor set per frame in flight
+ *
+ * The pass owns a command pool on the queue family it was created for, so its work can be
+ * submitted to an async compute queue and synchronized with graphics through semaphores.
+ * It can also be recorded into any other command buffer with Bind and PushConstants.
+ */
+class ComputePass {
+public:
+    using RecordFunc = std::function<void(vk::raii::CommandBuffer&)>;
+
+    ComputePass(const vk::raii::Device& device, const vk::raii::Queue& queue, uint32_t queueFamilyIndex, const ComputePassDesc& desc);
+
+    void WriteStorageImage(uint32_t frameIndex, uint32_t binding, vk::ImageView view) const;
+    void WriteStorageBuffer(uint32_t frameIndex, uint32_t binding, vk::Buffer buffer, vk::DeviceSize range = vk::WholeSize) const;
+    void WriteUniformBuffer(uint32_t frameIndex, uint32_t binding, vk::Buffer buffer, vk::DeviceSize range = vk::WholeSize) const;
+
+    void Bind(const vk::raii::CommandBuffer& cmd, uint32_t frameIndex) const;
+
+    template <typename T>
+    void PushConstants(const vk::raii::CommandBuffer& cmd, const T& constants) const {
+        cmd.pushConstants<T>(mPipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, constants);
+    }
+
+    // Records the pass with record and submits it once waitSemaphore is signaled, returns the
+    // semaphore that is signaled when the pass has finished
+    vk::Semaphore Submit(uint32_t frameIndex, vk::Semaphore waitSemaphore, vk::PipelineStageFlags waitStage, const RecordFunc& record);
+
+    [[nodiscard]] vk::Semaphore GetFinishedSemaphore(uint32_t frameIndex) const { return *mFinishedSemaphores[frameIndex]; }
+
+private:
+    void writeDescriptor(uint32_t frameIndex, uint32_t binding, vk::DescriptorType type, vk::Buffer buffer, vk::DeviceSize range) const;
+
+private:
+    const vk::raii::Device& mDevice;
+    const vk::raii::Queue& mQueue;
+
+    vk::raii::DescriptorSetLayout mDescriptorSetLayout = nullptr;
+    vk::raii::DescriptorPool mDescriptorPool = nullptr;
+    std::vector<vk::raii::DescriptorSet> mDescriptorSets;
+    vk::raii::PipelineLayout mPipelineLayout = nullptr;
+    vk::raii::Pipeline mPipeline = nullptr;
+
+    vk::raii::CommandPool mCommandPool = nullptr;
+    std::vector<vk::raii::CommandBuffer> mCommandBuffers;
+    std::vector<vk::raii::Semaphore> mFinishedSemaphores;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+
+namespace VE::Gfx {
+
+struct DynamicResolutionSettings {
+    bool enabled = false;           // Opt-in, frames render at the output resolution until enabled
+    float targetFrameTimeMs = 16.6f;
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+};
+
+/**
+ * Adjusts the internal render scale from measured GPU frame times
+ *
+ * Frame cost is assumed to scale with the pixel count, so the scale moves by the square root of
+ * the ratio between the budget and the smoothed frame time. A dead band and a per-update step
+ * limit keep the resolution from oscillating.
+ */
+class DynamicResolution {
+public:
+    void Configure(const DynamicResolutionSettings& settings);
+    void Update(float gpuFrameTimeMs);
+
+    [[nodiscard]] float GetScale() const { return mScale; }
+    [[nodiscard]] vk::Extent2D GetRenderExtent(vk::Extent2D outputExtent) const;
+
+private:
+    DynamicResolutionSettings mSettings;
+    float mScale = 1.0f;
+    float mSmoothedFrameTimeMs = 0.0f;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan_raii.hpp>
+
+namespace VE::Gfx {
+
+enum class CaptureFormat {
+    Png,
+    Raw     // Tightly packed RGBA8 rows, no header
+};
+
+/**
+ * Asynchronous readback of presented frames
+ *
+ * Frames are copied out of the swapchain image when the surface and format allow it, otherwise out
+ * of the post-processed image at the frame's render resolution. Copies are recorded into a ring of host-visible buffers and collected once the frame's fence
+ * has signaled, so the render thread never waits on the GPU. Finished buffers are handed to a
+ * pool of encoder threads which write them to disk and return them to the ring. When every
+ * buffer is busy the frame is dropped instead of stalling.
+ */
+class FrameCapture {
+public:
+    FrameCapture(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice);
+    ~FrameCapture();
+
+    // Continuously capture every presented frame into directory/frame_XXXXXX.<ext>. Raw output
+    // skips checksumming and is the format to use when recording at high resolutions.
+    void Start(const std::filesystem::path& directory, CaptureFormat format);
+    void Stop();
+
+    // Capture the next presented frame into path
+    void Screenshot(const std::filesystem::path& path, CaptureFormat format);
+
+    // Recreate the readback ring for source images up to extent, waits until the encoder released every buffer.
+    // Sources holding linear values that presentation stores sRGB encoded are encoded the same way.
+    void Resize(vk::Extent2D extent, vk::Format format, bool encodeSrgb = false);
+
+    [[nodiscard]] static bool IsFormatSupported(vk::Format format);
+
+    // Whether the frame being recorded should be copied
+    [[nodiscard]] bool IsCapturePending() const;
+
+    // Record a copy of the top left extent of image for the given frame in flight, the layout must allow transfer reads
+    void RecordCopy(const vk::raii::CommandBuffer& cmd, uint32_t frameIndex, vk::Image image, vk::ImageLayout layout, vk::Extent2D extent);
+
+    // Hand the copy made by frameIndex to the encoder, the frame's fence must have signaled
+    void Collect(uint32_t frameIndex);
+
+    [[nodiscard]] uint64_t GetDroppedFrameCount() const { return mDroppedFrames; }
+
+private:
+    enum class SlotState {
+        Free,
+        InFlight,
+        Encoding
+    };
+
+    struct Slot {
+        vk::raii::Buffer buffer = nullptr;
+        vk::raii::DeviceMemory memory = nullptr;
+        void* mapped = nullptr;
+        SlotState state = SlotState::Free;
+        uint32_t frameIndex = 0;
+        vk::Extent2D extent;
+        std::filesystem::path path;
+        CaptureFormat format = CaptureFormat::Png;
+    };
+
+    void allocateSlots();
+
+    // Both require mMutex to be held
+    void submitForEncoding(size_t index);
+    void flushInFlight();
+
+    void encoderLoop();
+    void encode(const Slot& slot) const;
+
+private:
+    const vk::raii::Device& mDevice;
+    const vk::raii::PhysicalDevice& mPhysicalDevice;
+
+    std::vector<Slot> mSlots;
+    vk::Extent2D mExtent;
+    vk::Format mFormat = vk::Format::eUndefined;
+    vk::DeviceSize mImageSize = 0;
+    bool mEncodeSrgb = false;
+    bool mSupported = false;
+    bool mCoherent = true;
+
+    // Capture requests, only touched by the render thread
+    bool mContinuous = false;
+    std::filesystem::path mDirectory;
+    CaptureFormat mContinuousFormat = CaptureFormat::Png;
+    std::filesystem::path mScreenshotPath;
+    CaptureFormat mScreenshotFormat = CaptureFormat::Png;
+    uint64_t mFrameCounter = 0;
+    uint64_t mDroppedFrames = 0;
+
+    // Encoder threads, mMutex guards the queue and every slot's state
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<size_t> mEncodeQueue;
+    bool mExit = false;
+    std::vector<std::thread> mEncoders;
+};
+
+}
\ No newline at end of file
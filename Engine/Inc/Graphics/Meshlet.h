@@ -0,0 +1,69 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace VE::Gfx {
+
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// Clusters merged and simplified together when building the next level of detail
+constexpr uint32_t MESHLET_GROUP_SIZE = 8;
+
+// Matches MeshVertex in meshlet_common.slang, vertices are pulled from a storage buffer
+struct MeshVertex {
+    glm::vec3 position = glm::vec3(0.0f);
+    uint32_t meshIndex = 0;
+    glm::vec3 normal = glm::vec3(0.0f, 0.0f, 1.0f);
+    float padding = 0.0f;
+};
+static_assert(sizeof(MeshVertex) == 32);
+
+// Matches MeshCluster in meshlet_common.slang, all bounds are in mesh space
+struct MeshCluster {
+    glm::vec3 center = glm::vec3(0.0f);     // Bounding sphere
+    float radius = 0.0f;
+    glm::vec3 coneApex = glm::vec3(0.0f);   // Normal cone, a cutoff of 1 disables cone culling
+    float coneCutoff = 1.0f;
+    glm::vec3 coneAxis = glm::vec3(0.0f);
+    uint32_t meshIndex = 0;
+
+    // Error of this cluster and of the coarser clusters that replace it, with the bounds of the
+    // group each was simplified from. A cluster is drawn when its own error is small enough on
+    // screen and its parent's is not.
+    glm::vec3 lodCenter = glm::vec3(0.0f);
+    float lodRadius = 0.0f;
+    glm::vec3 parentLodCenter = glm::vec3(0.0f);
+    float parentLodRadius = 0.0f;
+    float lodError = 0.0f;
+    float parentLodError = 0.0f;
+
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+static_assert(sizeof(MeshCluster) == 96);
+
+struct MeshletHierarchy {
+    std::vector<uint32_t> indices;          // Triangles of every cluster of every level
+    std::vector<MeshCluster> clusters;
+    uint32_t levelCount = 0;
+};
+
+/**
+ * Builds a continuous level of detail hierarchy of meshlets
+ *
+ * The mesh is split into meshlets of up to 64 vertices and 124 triangles. Neighbouring meshlets
+ * are then grouped, merged and simplified to half their triangle count with the group border
+ * locked, and the result is split into meshlets again. This repeats until the mesh cannot be
+ * simplified further. Because group borders never move, clusters from different levels can be
+ * mixed without cracks as long as the selection is consistent, which the monotonic errors and
+ * bounds stored in each cluster guarantee.
+ *
+ * Simplified levels reuse the original vertices, only indices are added.
+ */
+[[nodiscard]] MeshletHierarchy BuildMeshletHierarchy(std::span<const MeshVertex> vertices, std::span<const uint32_t> indices);
+
+}
\ No newline at end of file
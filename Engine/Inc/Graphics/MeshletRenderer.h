@@ -0,0 +1,121 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+#include <Graphics/Camera.h>
+#include <Graphics/ComputePass.h>
+#include <Graphics/Meshlet.h>
+#include <Graphics/PipelineLibrary.h>
+#include <Graphics/ResidencyManager.h>
+
+namespace VE::Gfx {
+
+using MeshHandle = uint32_t;
+
+struct MeshletStatistics {
+    uint32_t meshCount = 0;
+    uint32_t clusterCount = 0;          // Clusters of every level of every mesh
+    uint32_t triangleCount = 0;         // Triangles of the finest levels
+};
+
+/**
+ * GPU-driven rendering of meshlet hierarchies
+ *
+ * All meshes share one vertex, index and cluster buffer. They are streamable, grow geometrically
+ * and only the new range is uploaded when a mesh is added. Every frame a compute pass visits each
+ * cluster, keeps only those whose level of detail matches the error threshold in pixels and that
+ * are neither outside the frustum nor back-facing, and appends an indexed indirect draw for each.
+ * The survivors are then drawn with a single count-driven indirect draw.
+ *
+ * Meshes use counter-clockwise front faces and are assumed to be uniformly scaled when culling.
+ */
+class MeshletRenderer {
+public:
+    MeshletRenderer(
+        const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice,
+        const vk::raii::Queue& queue, uint32_t queueFamilyIndex, const PipelineLibrary& pipelines,
+        ResidencyManager& residency, vk::DescriptorSetLayout lightingSetLayout, vk::Format colorFormat, vk::Format depthFormat
+    );
+    ~MeshletRenderer();
+
+    // Builds the hierarchy and queues its upload, the mesh is drawn from the next frame on
+    MeshHandle AddMesh(std::span<const MeshVertex> vertices, std::span<const uint32_t> indices, const glm::mat4& transform = glm::mat4(1.0f));
+    void SetTransform(MeshHandle mesh, const glm::mat4& transform);
+
+    void SetErrorThreshold(float pixels) { mErrorThreshold = pixels; }
+
+    // Uploads the camera and transforms for the frame, its previous use must have completed. Called
+    // after the residency manager's update, so descriptors follow buffers it moved or grew.
+    void Update(uint32_t frameIndex, const Camera& camera, vk::Extent2D renderExtent);
+
+    // Records cluster selection, must be recorded outside of rendering and before Draw
+    void RecordCulling(const vk::raii::CommandBuffer& cmd, uint32_t frameIndex) const;
+    void RecordDraw(const vk::raii::CommandBuffer& cmd, uint32_t frameIndex, vk::DescriptorSet lightingSet) const;
+
+    [[nodiscard]] const MeshletStatistics& GetStatistics() const { return mStatistics; }
+
+private:
+    struct FrameResources {
+        vk::raii::Buffer cullData = nullptr;
+        vk::raii::DeviceMemory cullDataMemory = nullptr;
+        void* cullDataMapped = nullptr;
+
+        // Sized for the meshes and clusters of the frame, grown only once the frame's previous use completed
+        vk::raii::Buffer instances = nullptr;
+        vk::raii::DeviceMemory instancesMemory = nullptr;
+        void* instancesMapped = nullptr;
+        uint32_t instanceCapacity = 0;
+
+        vk::raii::Buffer draws = nullptr;
+        vk::raii::DeviceMemory drawsMemory = nullptr;
+        uint32_t drawCapacity = 0;
+
+        vk::raii::Buffer drawCount = nullptr;
+        vk::raii::DeviceMemory drawCountMemory = nullptr;
+
+        // Where the streamable buffers lived when the descriptors were last written
+        vk::Buffer boundVertices;
+        vk::Buffer boundIndices;
+        vk::Buffer boundClusters;
+        uint32_t clusterCount = 0;
+    };
+
+    void createPipeline(const PipelineLibrary& pipelines, vk::DescriptorSetLayout lightingSetLayout, vk::Format colorFormat, vk::Format depthFormat);
+    void createDescriptorSets();
+    void writeDescriptorSets(uint32_t frameIndex);
+
+    void appendBuffer(StreamableBufferHandle& buffer, vk::BufferUsageFlags usage, vk::DeviceSize offset, const void* data, vk::DeviceSize size);
+
+private:
+    const vk::raii::Device& mDevice;
+    const vk::raii::PhysicalDevice& mPhysicalDevice;
+    ResidencyManager& mResidency;
+
+    uint32_t mVertexCount = 0;
+    uint32_t mIndexCount = 0;
+    uint32_t mClusterCount = 0;
+    std::vector<glm::mat4> mTransforms;
+
+    float mErrorThreshold = 1.0f;
+    MeshletStatistics mStatistics;
+
+    StreamableBufferHandle mVertexBuffer = 0;
+    StreamableBufferHandle mIndexBuffer = 0;
+    StreamableBufferHandle mClusterBuffer = 0;
+    std::vector<FrameResources> mFrames;
+
+    std::unique_ptr<ComputePass> mCullPass;
+
+    vk::raii::DescriptorSetLayout mDescriptorSetLayout = nullptr;
+    vk::raii::DescriptorPool mDescriptorPool = nullptr;
+    std::vector<vk::raii::DescriptorSet> mDescriptorSets;
+    vk::raii::PipelineLayout mPipelineLayout = nullptr;
+    vk::raii::Pipeline mPipeline = nullptr;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan_raii.hpp>
+
+namespace VE::Gfx {
+
+/**
+ * Shader code and the driver's pipeline cache
+ *
+ * Everything is read from disk before the device exists, so file IO overlaps instance and
+ * device creation. Every saved pipeline cache is read up front, and the one written by the same
+ * device and driver seeds the new cache, which skips most shader compilation on startup.
+ */
+class PipelineLibrary {
+public:
+    void LoadShaders(const std::vector<std::string>& paths);
+    // Reads every file in directory that starts with a pipeline cache header
+    void LoadCacheData(const std::filesystem::path& directory);
+
+    void CreatePipelineCache(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice);
+    void SaveCacheData(const std::filesystem::path& path) const;
+
+    [[nodiscard]] const std::vector<char>& GetShader(const std::string& path) const;
+    [[nodiscard]] const vk::raii::PipelineCache& GetPipelineCache() const { return mPipelineCache; }
+
+private:
+    struct CacheFile {
+        vk::PipelineCacheHeaderVersionOne header;
+        std::vector<char> data;
+    };
+
+private:
+    std::unordered_map<std::string, std::vector<char>> mShaders;
+    std::vector<CacheFile> mCacheFiles;
+
+    vk::raii::PipelineCache mPipelineCache = nullptr;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan_raii.hpp>
+
+namespace VE::Gfx {
+
+using StreamableBufferHandle = uint32_t;
+
+struct HeapStatistics {
+    vk::DeviceSize size = 0;
+    vk::DeviceSize budget = 0;
+    vk::DeviceSize usage = 0;
+    bool deviceLocal = false;
+};
+
+struct MemoryStatistics {
+    std::vector<HeapStatistics> heaps;
+    bool budgetExtension = false;       // Budget and usage come from VK_EXT_memory_budget, otherwise estimated
+    uint32_t residentBuffers = 0;
+    uint32_t demotedBuffers = 0;
+    uint64_t evictions = 0;
+    uint64_t promotions = 0;
+};
+
+/**
+ * Keeps streamable buffers within the device-local memory budget
+ *
+ * Heap budgets and usage are queried every frame. When device-local usage approaches the
+ * budget, the least recently used buffers are copied to host memory, where the GPU can
+ * still read them at lower bandwidth. Once there is headroom again, the most recently used
+ * demoted buffers are promoted back. Allocations that do not fit are placed in host memory
+ * instead of failing.
+ *
+ * Buffers can move between frames, so users fetch the current handle with Use every frame.
+ * Replaced allocations are released once every frame that might reference them has finished.
+ */
+class ResidencyManager {
+public:
+    ResidencyManager(
+        const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice,
+        const vk::raii::Queue& queue, uint32_t queueFamilyIndex, bool memoryBudget
+    );
+
+    StreamableBufferHandle CreateBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, const void* data = nullptr);
+    void DestroyBuffer(StreamableBufferHandle handle);
+
+    // Moves the buffer into a new allocation of the given size, keeping the contents both sizes cover
+    void ResizeBuffer(StreamableBufferHandle handle, vk::DeviceSize size);
+
+    // Writes to memory the host can map land immediately, others are staged and copied ahead of the
+    // next frame's work. The range must not be in use by frames in flight.
+    void WriteBuffer(StreamableBufferHandle handle, vk::DeviceSize offset, const void* data, vk::DeviceSize size);
+
+    [[nodiscard]] vk::DeviceSize GetSize(StreamableBufferHandle handle) const;
+
+    // Marks the buffer as used by the frame being recorded and returns where it lives this frame
+    vk::Buffer Use(StreamableBufferHandle handle);
+
+    // Called once per frame after the frame's fence has signaled and before its work is submitted
+    void Update(uint32_t frameIndex);
+
+    [[nodiscard]] const MemoryStatistics& GetStatistics() const { return mStatistics; }
+
+private:
+    struct Allocation {
+        vk::raii::Buffer buffer = nullptr;
+        vk::raii::DeviceMemory memory = nullptr;
+        vk::DeviceSize size = 0;
+        uint32_t memoryType = 0;
+        uint32_t heapIndex = 0;
+    };
+
+    struct Resource {
+        Allocation allocation;
+        vk::DeviceSize size = 0;
+        vk::BufferUsageFlags usage;
+        bool resident = false;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    struct RetiredAllocation {
+        Allocation allocation;
+        uint64_t frame = 0;
+    };
+
+    struct PendingCopy {
+        vk::Buffer src;
+        vk::Buffer dst;
+        vk::DeviceSize srcOffset = 0;
+        vk::DeviceSize dstOffset = 0;
+        vk::DeviceSize size = 0;
+    };
+
+    [[nodiscard]] std::optional<uint32_t> findMemoryType(uint32_t typeFilter, bool deviceLocal) const;
+    bool allocate(vk::DeviceSize size, vk::BufferUsageFlags usage, bool deviceLocal, Allocation& allocation);
+    bool allocateStreamable(vk::DeviceSize size, vk::BufferUsageFlags usage, Allocation& allocation);
+    void retire(Allocation&& allocation);
+    void releaseRetired();
+
+    void queryBudget();
+    [[nodiscard]] vk::DeviceSize projectedUsage() const;
+    void move(Resource& resource, bool toDevice);
+    void evict(vk::DeviceSize target);
+    void promote(vk::DeviceSize target);
+
+    void submitCopies(uint32_t frameIndex);
+
+private:
+    const vk::raii::Device& mDevice;
+    const vk::raii::PhysicalDevice& mPhysicalDevice;
+    const vk::raii::Queue& mQueue;
+    bool mMemoryBudget = false;
+
+    vk::PhysicalDeviceMemoryProperties mMemoryProperties;
+    uint32_t mDeviceMemoryType = 0;
+    uint32_t mHostMemoryType = 0;
+    uint32_t mDeviceHeap = 0;
+    bool mCanDemote = false;
+
+    std::unordered_map<StreamableBufferHandle, Resource> mResources;
+    StreamableBufferHandle mNextHandle = 1;
+
+    std::vector<RetiredAllocation> mRetired;
+    std::vector<PendingCopy> mPendingCopies;
+    std::vector<vk::DeviceSize> mTrackedUsage;     // Bytes allocated per heap by this manager
+    vk::DeviceSize mPendingRelease = 0;            // Device-local bytes retired but not released yet
+    uint64_t mFrameCount = 0;
+
+    vk::raii::CommandPool mCommandPool = nullptr;
+    std::vector<vk::raii::CommandBuffer> mCommandBuffers;
+
+    MemoryStatistics mStatistics;
+};
+
+}
\ No newline at end of file
@@ -1,15 +1,37 @@
 #pragma once
 
+#include <filesystem>
+#include <memory>
 #include <vector>
 
 #include <vulkan/vulkan_raii.hpp>
 
+#include <Core/TaskGraph.h>
+#include <Graphics/Camera.h>
+#include <Graphics/ClusteredLighting.h>
+#include <Graphics/ComputePass.h>
+#include <Graphics/DynamicResolution.h>
+#include <Graphics/FrameCapture.h>
+#include <Graphics/MeshletRenderer.h>
+#include <Graphics/PipelineLibrary.h>
+#include <Graphics/ResidencyManager.h>
+
 class GLFWwindow;
 
 namespace VE::Gfx {
 
 constexpr int MAX_FRAMES_IN_FLIGHT = 3;
 
+constexpr vk::Format SCENE_COLOR_FORMAT = vk::Format::eR16G16B16A16Sfloat;
+constexpr vk::Format POST_PROCESS_FORMAT = vk::Format::eR8G8B8A8Unorm;
+constexpr vk::Format DEPTH_FORMAT = vk::Format::eD32Sfloat;
+
+struct RenderTarget {
+    vk::raii::Image image = nullptr;
+    vk::raii::DeviceMemory memory = nullptr;
+    vk::raii::ImageView view = nullptr;
+};
+
 class VulkanContext {
 public:
     VulkanContext(void* window);
@@ -17,19 +39,53 @@ public:
 
     void Render();
 
+    FrameCapture& GetFrameCapture() { return *mFrameCapture; }
+    DynamicResolution& GetDynamicResolution() { return mDynamicResolution; }
+    ResidencyManager& GetResidencyManager() { return *mResidencyManager; }
+    ClusteredLighting& GetLighting() { return *mLighting; }
+    MeshletRenderer& GetMeshletRenderer() { return *mMeshletRenderer; }
+
+    void SetCamera(const Camera& camera) { mCamera = camera; }
+
+    // Time spent in each startup task, independent tasks ran in parallel
+    [[nodiscard]] const std::vector<Core::TaskTiming>& GetStartupTimings() const { return mStartupTimings; }
+
+    // GPU time of the last measured frame, post-processing on an async compute queue only counts where it outlasts the graphics work
+    [[nodiscard]] float GetGpuFrameTime() const { return mGpuFrameTimeMs; }
+
 private:
+    struct DeviceCandidate {
+        vk::raii::PhysicalDevice device = nullptr;
+        uint64_t score = 0;
+    };
+
     void createInstance();
+    void enumeratePhysicalDevices();
     void selectPhysicalDevice();
     void createLogicalDevice();
     void createSurface();
     void createSwapchain();
     void allocateCommandBuffers();
     void createSyncObjects();
+
+    void createLighting();
     void createGraphicsPipeline();
+    void createMeshletRenderer();
+    void createRenderTargets();
+    void createPostProcessPasses();
+    void createCompositePass();
+    void createTimestampQueries();
     
     [[nodiscard]] vk::raii::ShaderModule createShaderModule(const std::vector<char>& code) const;
 
-    void recordCommandBuffer(uint32_t imageIndex);
+    void readFrameTimings(uint32_t frameIndex);
+
+    void recordSceneCommandBuffer(uint32_t frameIndex);
+    void recordPostProcess(vk::raii::CommandBuffer& cmd, uint32_t frameIndex);
+    void recordCompositeCommandBuffer(uint32_t frameIndex, uint32_t imageIndex);
+
+    [[nodiscard]] bool presentPendingFrame();
+    void discardFrame(uint32_t frameIndex);
 
     void recreateSwapchain();
 
@@ -38,11 +94,18 @@ private:
     vk::raii::Instance mInstance = nullptr;
     vk::raii::PhysicalDevice mPhysicalDevice = nullptr;
     vk::raii::Device mDevice = nullptr;
+    std::vector<DeviceCandidate> mDeviceCandidates;     // Suitable devices, best first
+    std::filesystem::path mPipelineCachePath;
     vk::raii::Queue mGraphicsQueue = nullptr;
+    vk::raii::Queue mComputeQueue = nullptr;
+    uint32_t mGraphicsQueueFamily = 0;
+    uint32_t mComputeQueueFamily = 0;
     vk::raii::SurfaceKHR mSurface = nullptr;
     vk::raii::SwapchainKHR mSwapchain = nullptr;
     vk::raii::CommandPool mCommandPool = nullptr;
+    std::vector<vk::raii::CommandBuffer> mSceneCommandBuffers;
     std::vector<vk::raii::CommandBuffer> mCommandBuffers;
+    std::vector<vk::raii::Semaphore> mSceneFinishedSemaphores;
     std::vector<vk::raii::Semaphore> mRenderFinishedSemaphores;
     std::vector<vk::raii::Semaphore> mPresentCompleteSemaphores;
     std::vector<vk::raii::Fence> mDrawFences;
@@ -54,9 +117,54 @@ private:
     std::vector<vk::raii::ImageView> mSwapchainImageViews;
 
     uint32_t mFrameIndex = 0;
+    uint64_t mFrameCount = 0;
+
+    // Post-processing of a frame overlaps the next frame's geometry, so it is presented one frame later
+    bool mPendingPresent = false;
+    uint32_t mPendingFrameIndex = 0;
 
+    PipelineLibrary mPipelineLibrary;
     vk::raii::Pipeline mGraphicsPipeline = nullptr;
     vk::raii::PipelineLayout mPipelineLayout = nullptr;
+
+    std::vector<RenderTarget> mSceneColorTargets;
+    std::vector<RenderTarget> mDepthTargets;
+    std::vector<RenderTarget> mPostProcessTargets;
+    std::unique_ptr<ComputePass> mTonemapPass;
+    float mExposure = 1.0f;
+
+    // Composition blits into the swapchain image, unless the surface or its format cannot be blitted to
+    bool mBlitComposite = true;
+    vk::Format mCompositeFormat = vk::Format::eUndefined;
+    vk::raii::Sampler mCompositeSampler = nullptr;
+    vk::raii::DescriptorSetLayout mCompositeSetLayout = nullptr;
+    vk::raii::DescriptorPool mCompositeDescriptorPool = nullptr;
+    std::vector<vk::raii::DescriptorSet> mCompositeDescriptorSets;
+    vk::raii::PipelineLayout mCompositePipelineLayout = nullptr;
+    vk::raii::Pipeline mCompositePipeline = nullptr;
+
+    // Frames render at a dynamic resolution into the top-left corner of the targets and are upscaled on composition
+    DynamicResolution mDynamicResolution;
+    vk::Extent2D mRenderExtents[MAX_FRAMES_IN_FLIGHT];
+
+    vk::raii::QueryPool mTimestampQueryPool = nullptr;
+    float mTimestampPeriod = 0.0f;
+    bool mComputeTimestamps = false;
+    uint64_t mGraphicsTimestampMask = 0;
+    uint64_t mComputeTimestampMask = 0;
+    float mGpuFrameTimeMs = 0.0f;
+
+    bool mSwapchainReadback = false;
+    std::unique_ptr<FrameCapture> mFrameCapture;
+
+    bool mMemoryBudgetSupported = false;
+    std::unique_ptr<ResidencyManager> mResidencyManager;
+
+    Camera mCamera;
+    std::unique_ptr<ClusteredLighting> mLighting;
+    std::unique_ptr<MeshletRenderer> mMeshletRenderer;
+
+    std::vector<Core::TaskTiming> mStartupTimings;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_raii.hpp>
+
+namespace VE::Gfx {
+
+[[nodiscard]] std::vector<char> ReadFile(const std::string& filename);
+
+[[nodiscard]] uint32_t FindMemoryType(const vk::raii::PhysicalDevice& physicalDevice, uint32_t typeFilter, vk::MemoryPropertyFlags properties);
+
+void CreateBuffer(
+    const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice,
+    vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties,
+    vk::raii::Buffer& buffer, vk::raii::DeviceMemory& bufferMemory
+);
+
+// Images shared by more than one queue family are created with concurrent sharing
+void CreateImage(
+    const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice,
+    uint32_t width, uint32_t height, vk::Format format, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties,
+    const std::vector<uint32_t>& queueFamilies, vk::raii::Image& image, vk::raii::DeviceMemory& imageMemory
+);
+
+[[nodiscard]] vk::raii::ImageView CreateImageView(
+    const vk::raii::Device& device, vk::Image image, vk::Format format,
+    vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor
+);
+
+}
\ No newline at end of file
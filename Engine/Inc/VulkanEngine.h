@@ -1,6 +1,8 @@
 #pragma once
 
+#include <filesystem>
 #include <memory>
+#include <span>
 
 #include <Graphics/VulkanContext.h>
 
@@ -14,6 +16,33 @@ public:
     bool Initialize(void* window);
     void Render();
 
+    // Frame capture, encoding happens on a background thread and never stalls rendering
+    void StartCapture(const std::filesystem::path& directory, Gfx::CaptureFormat format = Gfx::CaptureFormat::Png);
+    void StopCapture();
+    void Screenshot(const std::filesystem::path& path, Gfx::CaptureFormat format = Gfx::CaptureFormat::Png);
+    [[nodiscard]] uint64_t GetDroppedCaptureFrames() const;
+
+    // Dynamic resolution, off by default. Once enabled the render scale follows measured GPU frame times to hold the target budget
+    void SetDynamicResolution(const Gfx::DynamicResolutionSettings& settings);
+    [[nodiscard]] float GetRenderScale() const;
+    [[nodiscard]] float GetGpuFrameTime() const;
+
+    // Duration of each startup phase, independent phases ran in parallel
+    [[nodiscard]] const std::vector<Core::TaskTiming>& GetStartupTimings() const;
+
+    // Per-heap budget and usage, refreshed every frame
+    [[nodiscard]] const Gfx::MemoryStatistics& GetMemoryStatistics() const;
+
+    // Clustered lighting, lights are binned per frame so any number up to MAX_LIGHTS can change freely
+    void SetLights(std::span<const Gfx::Light> lights);
+    void SetCamera(const Gfx::Camera& camera);
+
+    // Meshlet geometry, the level of detail of each cluster is chosen on the GPU every frame
+    Gfx::MeshHandle AddMesh(std::span<const Gfx::MeshVertex> vertices, std::span<const uint32_t> indices, const glm::mat4& transform = glm::mat4(1.0f));
+    void SetMeshTransform(Gfx::MeshHandle mesh, const glm::mat4& transform);
+    void SetLodErrorThreshold(float pixels);
+    [[nodiscard]] const Gfx::MeshletStatistics& GetMeshletStatistics() const;
+
 private:
     std::unique_ptr<Gfx::VulkanContext> mContext;
 };
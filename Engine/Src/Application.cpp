@@ -1,5 +1,7 @@
 #include <Application.h>
 
+#include <iostream>
+
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
@@ -39,6 +41,10 @@ bool Application::initialize() {
         return false;
     }
 
+#ifndef NDEBUG
+    std::cout << "Startup\n" << Core::TaskGraph::Report(mEngine->GetStartupTimings()) << std::flush;
+#endif
+
     return true;
 }
 
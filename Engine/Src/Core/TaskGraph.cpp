@@ -0,0 +1,171 @@
+#include <Core/TaskGraph.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace VE::Core {
+
+using Clock = std::chrono::steady_clock;
+
+// -----------------------------------------------------------------------------------------------
+// TaskGraph
+// -----------------------------------------------------------------------------------------------
+TaskId TaskGraph::Add(std::string name, TaskFunc func, std::vector<TaskId> dependencies, bool mainThread) {
+    const auto id = static_cast<TaskId>(mTasks.size());
+
+    for (TaskId dependency : dependencies) {
+        if (dependency >= id) {
+            throw std::runtime_error("task dependency must be added before its dependants!");
+        }
+        mTasks[dependency].dependants.push_back(id);
+    }
+
+    mTasks.push_back({
+        .name = std::move(name),
+        .func = std::move(func),
+        .dependants = {},
+        .dependencyCount = static_cast<uint32_t>(dependencies.size()),
+        .mainThread = mainThread
+    });
+
+    return id;
+}
+
+void TaskGraph::Run(uint32_t threadCount) {
+    const auto start = Clock::now();
+    auto elapsedMs = [start](Clock::time_point time) {
+        return std::chrono::duration<double, std::milli>(time - start).count();
+    };
+
+    mTimings.assign(mTasks.size(), {});
+
+    std::mutex mutex;
+    std::condition_variable taskChanged;
+    std::deque<TaskId> ready;
+    std::deque<TaskId> mainReady;
+    std::vector<uint32_t> remaining(mTasks.size());
+    size_t finished = 0;
+    size_t running = 0;
+    std::exception_ptr error;
+
+    auto schedule = [&](TaskId id) {
+        (mTasks[id].mainThread ? mainReady : ready).push_back(id);
+    };
+
+    for (TaskId id = 0; id < mTasks.size(); ++id) {
+        remaining[id] = mTasks[id].dependencyCount;
+        if (remaining[id] == 0) {
+            schedule(id);
+        }
+    }
+
+    auto done = [&] {
+        return finished == mTasks.size() || (error && running == 0);
+    };
+
+    // Pulls tasks from queue until the graph is done, the lock is only released while a task runs
+    auto work = [&](std::deque<TaskId>& queue, uint32_t thread) {
+        std::unique_lock lock(mutex);
+        while (true) {
+            taskChanged.wait(lock, [&] { return done() || (!error && !queue.empty()); });
+            if (done()) {
+                return;
+            }
+
+            const TaskId id = queue.front();
+            queue.pop_front();
+            ++running;
+
+            lock.unlock();
+            const auto taskStart = Clock::now();
+            std::exception_ptr taskError;
+            try {
+                mTasks[id].func();
+            }
+            catch (...) {
+                taskError = std::current_exception();
+            }
+            const auto taskEnd = Clock::now();
+            lock.lock();
+
+            --running;
+            ++finished;
+            mTimings[id] = {
+                .name = mTasks[id].name,
+                .thread = thread,
+                .startMs = elapsedMs(taskStart),
+                .durationMs = std::chrono::duration<double, std::milli>(taskEnd - taskStart).count()
+            };
+
+            if (taskError) {
+                if (!error) {
+                    error = taskError;
+                }
+            }
+            else {
+                for (TaskId dependant : mTasks[id].dependants) {
+                    if (--remaining[dependant] == 0) {
+                        schedule(dependant);
+                    }
+                }
+            }
+
+            taskChanged.notify_all();
+        }
+    };
+
+    const auto workerTasks = static_cast<uint32_t>(std::ranges::count_if(mTasks, [](const Task& task) { return !task.mainThread; }));
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, workerTasks);
+
+    {
+        std::vector<std::jthread> workers;
+        for (uint32_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back([&work, &ready, i] { work(ready, i + 1); });
+        }
+
+        work(mainReady, 0);
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+std::string TaskGraph::Report(const std::vector<TaskTiming>& timings) {
+    std::vector<const TaskTiming*> ordered;
+    double summedMs = 0.0;
+    double wallMs = 0.0;
+    for (const auto& timing : timings) {
+        ordered.push_back(&timing);
+        summedMs += timing.durationMs;
+        wallMs = std::max(wallMs, timing.startMs + timing.durationMs);
+    }
+    std::ranges::sort(ordered, {}, &TaskTiming::startMs);
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(2);
+    for (const TaskTiming* timing : ordered) {
+        report << "  " << std::left << std::setw(28) << timing->name << std::right
+               << " start " << std::setw(8) << timing->startMs << " ms"
+               << "  took " << std::setw(8) << timing->durationMs << " ms"
+               << "  thread " << timing->thread << "\n";
+    }
+    report << "  " << std::left << std::setw(28) << "Total" << std::right
+           << " wall " << std::setw(9) << wallMs << " ms"
+           << "  tasks " << std::setw(7) << summedMs << " ms\n";
+
+    return report.str();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include <Graphics/ClusteredLighting.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include <Graphics/VulkanContext.h>
+#include <Graphics/VulkanUtils.h>
+
+namespace VE::Gfx {
+
+constexpr uint32_t CULL_GROUP_SIZE = 128;
+
+// Matches the std140 layout of FrameData in clustered_common.slang
+struct FrameData {
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::mat4 invProj;
+    glm::uvec4 clusterGrid;     // x, y, z, light count
+    glm::vec4 viewport;         // width, height, near, far
+    glm::uvec4 limits;          // light index capacity
+};
+
+// -----------------------------------------------------------------------------------------------
+// ClusteredLighting
+// -----------------------------------------------------------------------------------------------
+ClusteredLighting::ClusteredLighting(
+    const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice,
+    const vk::raii::Queue& queue, uint32_t queueFamilyIndex, const PipelineLibrary& pipelines,
+    ResidencyManager& residency
+) : mDevice(device), mPhysicalDevice(physicalDevice), mResidency(residency) {
+    ComputePassDesc cullDesc {
+        .code = pipelines.GetShader("Assets/Shader/clustered_cull.spv"),
+        .entryPoint = "compMain",
+        .bindings = {
+            { .binding = 0, .descriptorType = vk::DescriptorType::eUniformBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute },
+            { .binding = 1, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute },
+            { .binding = 2, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute },
+            { .binding = 3, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute }
+        },
+        .pipelineCache = &pipelines.GetPipelineCache()
+    };
+    mCullPass = std::make_unique<ComputePass>(mDevice, queue, queueFamilyIndex, cullDesc);
+
+    createBuffers();
+    createDescriptorSets();
+}
+
+ClusteredLighting::~ClusteredLighting() {
+    for (const auto& frame : mFrames) {
+        mResidency.DestroyBuffer(frame.lightGrid);
+        mResidency.DestroyBuffer(frame.lightIndices);
+    }
+}
+
+void ClusteredLighting::SetLights(std::span<const Light> lights) {
+    const size_t count = std::min<size_t>(lights.size(), MAX_LIGHTS);
+    mLights.assign(lights.begin(), lights.begin() + count);
+}
+
+void ClusteredLighting::Update(uint32_t frameIndex, const Camera& camera, vk::Extent2D renderExtent) {
+    auto& frame = mFrames[frameIndex];
+
+    const glm::mat4 proj = camera.GetProjection(static_cast<float>(renderExtent.width) / static_cast<float>(renderExtent.height));
+    const FrameData frameData {
+        .view = camera.view,
+        .proj = proj,
+        .invProj = glm::inverse(proj),
+        .clusterGrid = { CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z, static_cast<uint32_t>(mLights.size()) },
+        .viewport = { static_cast<float>(renderExtent.width), static_cast<float>(renderExtent.height), camera.zNear, camera.zFar },
+        .limits = { MAX_LIGHT_INDICES, 0, 0, 0 }
+    };
+
+    std::memcpy(frame.frameDataMapped, &frameData, sizeof(frameData));
+    if (!mLights.empty()) {
+        std::memcpy(frame.lightsMapped, mLights.data(), mLights.size() * sizeof(Light));
+    }
+
+    if (mResidency.Use(frame.lightGrid) != frame.boundLightGrid || mResidency.Use(frame.lightIndices) != frame.boundLightIndices) {
+        writeDescriptorSets(frameIndex);
+    }
+}
+
+void ClusteredLighting::RecordCulling(const vk::raii::CommandBuffer& cmd, uint32_t frameIndex) const {
+    const auto& frame = mFrames[frameIndex];
+
+    // The first element of the index list is the allocation counter
+    cmd.fillBuffer(frame.boundLightIndices, 0, sizeof(uint32_t), 0);
+
+    vk::BufferMemoryBarrier2 clearBarrier {
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = frame.boundLightIndices,
+        .offset = 0,
+        .size = sizeof(uint32_t)
+    };
+    cmd.pipelineBarrier2({ .bufferMemoryBarrierCount = 1, .pBufferMemoryBarriers = &clearBarrier });
+
+    mCullPass->Bind(cmd, frameIndex);
+    cmd.dispatch((CLUSTER_COUNT + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    // Clusters are read by fragment shading
+    vk::MemoryBarrier2 cullBarrier {
+        .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader,
+        .dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead
+    };
+    cmd.pipelineBarrier2({ .memoryBarrierCount = 1, .pMemoryBarriers = &cullBarrier });
+}
+
+void ClusteredLighting::createBuffers() {
+    constexpr auto hostVisible = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+    mFrames.resize(MAX_FRAMES_IN_FLIGHT);
+    for (auto& frame : mFrames) {
+        CreateBuffer(mDevice, mPhysicalDevice, sizeof(FrameData), vk::BufferUsageFlagBits::eUniformBuffer, hostVisible, frame.frameData, frame.frameDataMemory);
+        frame.frameDataMapped = frame.frameDataMemory.mapMemory(0, sizeof(FrameData));
+
+        CreateBuffer(mDevice, mPhysicalDevice, sizeof(Light) * MAX_LIGHTS, vk::BufferUsageFlagBits::eStorageBuffer, hostVisible, frame.lights, frame.lightsMemory);
+        frame.lightsMapped = frame.lightsMemory.mapMemory(0, sizeof(Light) * MAX_LIGHTS);
+
+        // Rebuilt every frame, demoting them only costs shading bandwidth
+        frame.lightGrid = mResidency.CreateBuffer(sizeof(glm::uvec2) * CLUSTER_COUNT, vk::BufferUsageFlagBits::eStorageBuffer);
+        frame.lightIndices = mResidency.CreateBuffer(sizeof(uint32_t) * (MAX_LIGHT_INDICES + 1), vk::BufferUsageFlagBits::eStorageBuffer);
+    }
+}
+
+void ClusteredLighting::createDescriptorSets() {
+    std::array bindings = {
+        vk::DescriptorSetLayoutBinding { .binding = 0, .descriptorType = vk::DescriptorType::eUniformBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment },
+        vk::DescriptorSetLayoutBinding { .binding = 1, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eFragment },
+        vk::DescriptorSetLayoutBinding { .binding = 2, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eFragment },
+        vk::DescriptorSetLayoutBinding { .binding = 3, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eFragment }
+    };
+
+    vk::DescriptorSetLayoutCreateInfo layoutInfo {
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
+    };
+    mDescriptorSetLayout = vk::raii::DescriptorSetLayout(mDevice, layoutInfo);
+
+    std::array poolSizes = {
+        vk::DescriptorPoolSize { .type = vk::DescriptorType::eUniformBuffer, .descriptorCount = MAX_FRAMES_IN_FLIGHT },
+        vk::DescriptorPoolSize { .type = vk::DescriptorType::eStorageBuffer, .descriptorCount = 3 * MAX_FRAMES_IN_FLIGHT }
+    };
+
+    vk::DescriptorPoolCreateInfo poolInfo {
+        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = MAX_FRAMES_IN_FLIGHT,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data()
+    };
+    mDescriptorPool = vk::raii::DescriptorPool(mDevice, poolInfo);
+
+    std::vector<vk::DescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, *mDescriptorSetLayout);
+    vk::DescriptorSetAllocateInfo allocInfo {
+        .descriptorPool = mDescriptorPool,
+        .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
+        .pSetLayouts = layouts.data()
+    };
+    mDescriptorSets = mDevice.allocateDescriptorSets(allocInfo);
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        writeDescriptorSets(i);
+    }
+}
+
+void ClusteredLighting::writeDescriptorSets(uint32_t frameIndex) {
+    auto& frame = mFrames[frameIndex];
+    frame.boundLightGrid = mResidency.Use(frame.lightGrid);
+    frame.boundLightIndices = mResidency.Use(frame.lightIndices);
+
+    mCullPass->WriteUniformBuffer(frameIndex, 0, frame.frameData);
+    mCullPass->WriteStorageBuffer(frameIndex, 1, frame.lights);
+    mCullPass->WriteStorageBuffer(frameIndex, 2, frame.boundLightGrid);
+    mCullPass->WriteStorageBuffer(frameIndex, 3, frame.boundLightIndices);
+
+    const std::array bufferInfos = {
+        vk::DescriptorBufferInfo { .buffer = frame.frameData, .offset = 0, .range = vk::WholeSize },
+        vk::DescriptorBufferInfo { .buffer = frame.lights, .offset = 0, .range = vk::WholeSize },
+        vk::DescriptorBufferInfo { .buffer = frame.boundLightGrid, .offset = 0, .range = vk::WholeSize },
+        vk::DescriptorBufferInfo { .buffer = frame.boundLightIndices, .offset = 0, .range = vk::WholeSize }
+    };
+
+    std::vector<vk::WriteDescriptorSet> writes;
+    for (uint32_t binding = 0; binding < bufferInfos.size(); ++binding) {
+        writes.push_back({
+            .dstSet = mDescriptorSets[frameIndex],
+            .dstBinding = binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = binding == 0 ? vk::DescriptorType::eUniformBuffer : vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &bufferInfos[binding]
+        });
+    }
+    mDevice.updateDescriptorSets(writes, {});
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <Graphics/ComputePass.h>
+
+#include <Graphics/VulkanContext.h>
+
+namespace VE::Gfx {
+
+// -----------------------------------------------------------------------------------------------
+// ComputePass
+// -----------------------------------------------------------------------------------------------
+ComputePass::ComputePass(const vk::raii::Device& device, const vk::raii::Queue& queue, uint32_t queueFamilyIndex, const ComputePassDesc& desc)
+    : mDevice(device), mQueue(queue) {
+    // Descriptor sets
+    vk::DescriptorSetLayoutCreateInfo layoutInfo {
+        .bindingCount = static_cast<uint32_t>(desc.bindings.size()),
+        .pBindings = desc.bindings.data()
+    };
+    mDescriptorSetLayout = vk::raii::DescriptorSetLayout(mDevice, layoutInfo);
+
+    if (!desc.bindings.empty()) {
+        std::vector<vk::DescriptorPoolSize> poolSizes;
+        for (const auto& binding : desc.bindings) {
+            poolSizes.push_back({ .type = binding.descriptorType, .descriptorCount = binding.descriptorCount * MAX_FRAMES_IN_FLIGHT });
+        }
+
+        vk::DescriptorPoolCreateInfo poolInfo {
+            .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+            .maxSets = MAX_FRAMES_IN_FLIGHT,
+            .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+            .pPoolSizes = poolSizes.data()
+        };
+        mDescriptorPool = vk::raii::DescriptorPool(mDevice, poolInfo);
+
+        std::vector<vk::DescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, *mDescriptorSetLayout);
+        vk::DescriptorSetAllocateInfo allocInfo {
+            .descriptorPool = mDescriptorPool,
+            .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
+            .pSetLayouts = layouts.data()
+        };
+        mDescriptorSets = mDevice.allocateDescriptorSets(allocInfo);
+    }
+
+    // Pipeline
+    vk::PushConstantRange pushConstantRange {
+        .stageFlags = vk::ShaderStageFlagBits::eCompute,
+        .offset = 0,
+        .size = desc.pushConstantSize
+    };
+
+    vk::PipelineLayoutCreateInfo pipelineLayoutInfo {
+        .setLayoutCount = 1,
+        .pSetLayouts = &*mDescriptorSetLayout,
+        .pushConstantRangeCount = desc.pushConstantSize > 0 ? 1u : 0u,
+        .pPushConstantRanges = &pushConstantRange
+    };
+    mPipelineLayout = vk::raii::PipelineLayout(mDevice, pipelineLayoutInfo);
+
+    vk::ShaderModuleCreateInfo smCreateInfo {
+        .codeSize = desc.code.size() * sizeof(char),
+        .pCode = reinterpret_cast<const uint32_t*>(desc.code.data())
+    };
+    vk::raii::ShaderModule shaderModule(mDevice, smCreateInfo);
+
+    vk::ComputePipelineCreateInfo pipelineInfo {
+        .stage = {
+            .stage = vk::ShaderStageFlagBits::eCompute,
+            .module = shaderModule,
+            .pName = desc.entryPoint
+        },
+        .layout = mPipelineLayout
+    };
+    mPipeline = vk::raii::Pipeline(mDevice, desc.pipelineCache, pipelineInfo);
+
+    // Submission
+    vk::CommandPoolCreateInfo poolInfo {
+        .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+        .queueFamilyIndex = queueFamilyIndex
+    };
+    mCommandPool = vk::raii::CommandPool(mDevice, poolInfo);
+
+    vk::CommandBufferAllocateInfo allocInfo {
+        .commandPool = mCommandPool,
+        .level = vk::CommandBufferLevel::ePrimary,
+        .commandBufferCount = MAX_FRAMES_IN_FLIGHT
+    };
+    mCommandBuffers = vk::raii::CommandBuffers(mDevice, allocInfo);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        mFinishedSemaphores.emplace_back(mDevice, vk::SemaphoreCreateInfo());
+    }
+}
+
+void ComputePass::WriteStorageImage(uint32_t frameIndex, uint32_t binding, vk::ImageView view) const {
+    vk::DescriptorImageInfo imageInfo {
+        .imageView = view,
+        .imageLayout = vk::ImageLayout::eGeneral
+    };
+
+    vk::WriteDescriptorSet write {
+        .dstSet = mDescriptorSets[frameIndex],
+        .dstBinding = binding,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = vk::DescriptorType::eStorageImage,
+        .pImageInfo = &imageInfo
+    };
+    mDevice.updateDescriptorSets(write, {});
+}
+
+void ComputePass::WriteStorageBuffer(uint32_t frameIndex, uint32_t binding, vk::Buffer buffer, vk::DeviceSize range) const {
+    writeDescriptor(frameIndex, binding, vk::DescriptorType::eStorageBuffer, buffer, range);
+}
+
+void ComputePass::WriteUniformBuffer(uint32_t frameIndex, uint32_t binding, vk::Buffer buffer, vk::DeviceSize range) const {
+    writeDescriptor(frameIndex, binding, vk::DescriptorType::eUniformBuffer, buffer, range);
+}
+
+void ComputePass::Bind(const vk::raii::CommandBuffer& cmd, uint32_t frameIndex) const {
+    cmd.bindPipeline(vk::PipelineBindPoint::eCompute, mPipeline);
+    if (!mDescriptorSets.empty()) {
+        cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, mPipelineLayout, 0, *mDescriptorSets[frameIndex], nullptr);
+    }
+}
+
+vk::Semaphore ComputePass::Submit(uint32_t frameIndex, vk::Semaphore waitSemaphore, vk::PipelineStageFlags waitStage, const RecordFunc& record) {
+    auto& cmd = mCommandBuffers[frameIndex];
+
+    cmd.reset();
+    cmd.begin({});
+    record(cmd);
+    cmd.end();
+
+    const vk::SubmitInfo submitInfo {
+        .waitSemaphoreCount = waitSemaphore ? 1u : 0u,
+        .pWaitSemaphores = &waitSemaphore,
+        .pWaitDstStageMask = &waitStage,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &*cmd,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &*mFinishedSemaphores[frameIndex]
+    };
+    mQueue.submit(submitInfo);
+
+    return *mFinishedSemaphores[frameIndex];
+}
+
+void ComputePass::writeDescriptor(uint32_t frameIndex, uint32_t binding, vk::DescriptorType type, vk::Buffer buffer, vk::DeviceSize range) const {
+    vk::DescriptorBufferInfo bufferInfo {
+        .buffer = buffer,
+        .offset = 0,
+        .range = range
+    };
+
+    vk::WriteDescriptorSet write {
+        .dstSet = mDescriptorSets[frameIndex],
+        .dstBinding = binding,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = type,
+        .pBufferInfo = &bufferInfo
+    };
+    mDevice.updateDescriptorSets(write, {});
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include <Graphics/DynamicResolution.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace VE::Gfx {
+
+constexpr float FRAME_TIME_SMOOTHING = 0.1f;   // Weight of the newest sample
+constexpr float BUDGET_HEADROOM = 0.9f;        // Aim below the budget to absorb spikes
+constexpr float DEAD_BAND = 0.05f;             // Relative error ignored around the aim
+constexpr float MAX_SCALE_STEP = 0.05f;
+
+// -----------------------------------------------------------------------------------------------
+// DynamicResolution
+// -----------------------------------------------------------------------------------------------
+void DynamicResolution::Configure(const DynamicResolutionSettings& settings) {
+    mSettings = settings;
+    mSettings.minScale = std::clamp(mSettings.minScale, 0.1f, 1.0f);
+    mSettings.maxScale = std::clamp(mSettings.maxScale, mSettings.minScale, 1.0f);
+
+    mScale = mSettings.enabled ? std::clamp(mScale, mSettings.minScale, mSettings.maxScale) : 1.0f;
+}
+
+void DynamicResolution::Update(float gpuFrameTimeMs) {
+    if (gpuFrameTimeMs <= 0.0f) {
+        return;
+    }
+
+    mSmoothedFrameTimeMs = mSmoothedFrameTimeMs > 0.0f
+        ? std::lerp(mSmoothedFrameTimeMs, gpuFrameTimeMs, FRAME_TIME_SMOOTHING)
+        : gpuFrameTimeMs;
+
+    if (!mSettings.enabled) {
+        return;
+    }
+
+    const float aim = mSettings.targetFrameTimeMs * BUDGET_HEADROOM;
+    const float ratio = aim / mSmoothedFrameTimeMs;
+    if (std::abs(ratio - 1.0f) < DEAD_BAND) {
+        return;
+    }
+
+    const float desired = mScale * std::sqrt(ratio);
+    const float step = std::clamp(desired - mScale, -MAX_SCALE_STEP, MAX_SCALE_STEP);
+    mScale = std::clamp(mScale + step, mSettings.minScale, mSettings.maxScale);
+}
+
+vk::Extent2D DynamicResolution::GetRenderExtent(vk::Extent2D outputExtent) const {
+    return {
+        std::max(1u, static_cast<uint32_t>(std::lround(static_cast<float>(outputExtent.width) * mScale))),
+        std::max(1u, static_cast<uint32_t>(std::lround(static_cast<float>(outputExtent.height) * mScale)))
+    };
+}
+
+}
\ No newline at end of file
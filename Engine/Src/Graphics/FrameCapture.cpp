@@ -0,0 +1,395 @@
+#include <Graphics/FrameCapture.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+
+#include <Graphics/VulkanContext.h>
+#include <Graphics/VulkanUtils.h>
+
+namespace VE::Gfx {
+
+// Encoding a full frame takes longer than rendering one, so several frames are encoded at once
+constexpr uint32_t MAX_ENCODER_THREADS = 4;
+
+// Zlib's limit on bytes summed before the Adler-32 sums have to be reduced
+constexpr size_t ADLER_BLOCK_SIZE = 5552;
+
+// -----------------------------------------------------------------------------------------------
+// Utility Functions
+// -----------------------------------------------------------------------------------------------
+bool IsBgraFormat(vk::Format format) {
+    return format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb;
+}
+
+uint8_t EncodeSrgb(uint8_t linear) {
+    static const auto table = [] {
+        std::array<uint8_t, 256> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            const float c = static_cast<float>(n) / 255.0f;
+            const float encoded = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            t[n] = static_cast<uint8_t>(std::lround(encoded * 255.0f));
+        }
+        return t;
+    }();
+
+    return table[linear];
+}
+
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    static const auto table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void AppendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void AppendPngChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+    AppendBigEndian(out, static_cast<uint32_t>(data.size()));
+
+    const size_t typeOffset = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+
+    AppendBigEndian(out, Crc32(0, out.data() + typeOffset, out.size() - typeOffset));
+}
+
+// Encodes RGBA8 pixels as PNG using stored (uncompressed) deflate blocks, encoding speed matters
+// more than file size for continuous capture
+std::vector<uint8_t> EncodePng(const uint8_t* rgba, uint32_t width, uint32_t height) {
+    const size_t rowSize = static_cast<size_t>(width) * 4;
+
+    // Every scanline is prefixed with filter type 0 (None)
+    std::vector<uint8_t> scanlines;
+    scanlines.reserve((rowSize + 1) * height);
+    for (uint32_t y = 0; y < height; ++y) {
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), rgba + y * rowSize, rgba + (y + 1) * rowSize);
+    }
+
+    // zlib stream
+    constexpr size_t MAX_STORED_BLOCK = 65535;
+    std::vector<uint8_t> zlib = { 0x78, 0x01 };
+    zlib.reserve(scanlines.size() + scanlines.size() / MAX_STORED_BLOCK * 5 + 16);
+
+    size_t offset = 0;
+    do {
+        const size_t blockSize = std::min(MAX_STORED_BLOCK, scanlines.size() - offset);
+        const bool finalBlock = offset + blockSize == scanlines.size();
+        zlib.push_back(finalBlock ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(blockSize));
+        zlib.push_back(static_cast<uint8_t>(blockSize >> 8));
+        zlib.push_back(static_cast<uint8_t>(~blockSize));
+        zlib.push_back(static_cast<uint8_t>(~blockSize >> 8));
+        zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+        offset += blockSize;
+    } while (offset < scanlines.size());
+
+    uint32_t a = 1, b = 0;
+    for (size_t block = 0; block < scanlines.size(); block += ADLER_BLOCK_SIZE) {
+        const size_t blockEnd = std::min(block + ADLER_BLOCK_SIZE, scanlines.size());
+        for (size_t i = block; i < blockEnd; ++i) {
+            a += scanlines[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    AppendBigEndian(zlib, (b << 16) | a);
+
+    // PNG container
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    std::vector<uint8_t> header;
+    AppendBigEndian(header, width);
+    AppendBigEndian(header, height);
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });     // 8 bit, RGBA, deflate, no filter, no interlace
+
+    AppendPngChunk(png, "IHDR", header);
+    AppendPngChunk(png, "IDAT", zlib);
+    AppendPngChunk(png, "IEND", {});
+
+    return png;
+}
+
+// -----------------------------------------------------------------------------------------------
+// FrameCapture
+// -----------------------------------------------------------------------------------------------
+FrameCapture::FrameCapture(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice)
+    : mDevice(device), mPhysicalDevice(physicalDevice) {
+    const uint32_t encoderCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, MAX_ENCODER_THREADS);
+    for (uint32_t i = 0; i < encoderCount; ++i) {
+        mEncoders.emplace_back(&FrameCapture::encoderLoop, this);
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    {
+        // The owner waits for the device to be idle first, so pending copies can still be written
+        std::lock_guard lock(mMutex);
+        flushInFlight();
+        mExit = true;
+    }
+    mCondition.notify_all();
+    for (auto& encoder : mEncoders) {
+        encoder.join();
+    }
+}
+
+void FrameCapture::Start(const std::filesystem::path& directory, CaptureFormat format) {
+    if (!mSupported) {
+        throw std::runtime_error("failed to start frame capture, the source image format cannot be read back!");
+    }
+
+    std::filesystem::create_directories(directory);
+
+    mContinuous = true;
+    mDirectory = directory;
+    mContinuousFormat = format;
+}
+
+void FrameCapture::Stop() {
+    mContinuous = false;
+}
+
+void FrameCapture::Screenshot(const std::filesystem::path& path, CaptureFormat format) {
+    if (!mSupported) {
+        throw std::runtime_error("failed to take screenshot, the source image format cannot be read back!");
+    }
+
+    mScreenshotPath = path;
+    mScreenshotFormat = format;
+}
+
+void FrameCapture::Resize(vk::Extent2D extent, vk::Format format, bool encodeSrgb) {
+    std::unique_lock lock(mMutex);
+
+    // The device is idle when the swapchain gets recreated, so copies still in flight are complete
+    flushInFlight();
+
+    mCondition.wait(lock, [this] {
+        return std::ranges::none_of(mSlots, [](const Slot& slot) { return slot.state != SlotState::Free; });
+    });
+
+    mExtent = extent;
+    mFormat = format;
+    mEncodeSrgb = encodeSrgb;
+    mImageSize = static_cast<vk::DeviceSize>(extent.width) * extent.height * 4;
+    mSupported = IsFormatSupported(format);
+
+    mSlots.clear();
+    if (mSupported) {
+        allocateSlots();
+    }
+}
+
+bool FrameCapture::IsFormatSupported(vk::Format format) {
+    switch (format) {
+    case vk::Format::eB8G8R8A8Unorm:
+    case vk::Format::eB8G8R8A8Srgb:
+    case vk::Format::eR8G8B8A8Unorm:
+    case vk::Format::eR8G8B8A8Srgb:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool FrameCapture::IsCapturePending() const {
+    return mSupported && (mContinuous || !mScreenshotPath.empty());
+}
+
+void FrameCapture::RecordCopy(const vk::raii::CommandBuffer& cmd, uint32_t frameIndex, vk::Image image, vk::ImageLayout layout, vk::Extent2D extent) {
+    Slot* slot = nullptr;
+    {
+        std::lock_guard lock(mMutex);
+        auto iter = std::ranges::find_if(mSlots, [](const Slot& s) { return s.state == SlotState::Free; });
+        if (iter != mSlots.end()) {
+            slot = &*iter;
+            slot->state = SlotState::InFlight;
+            slot->frameIndex = frameIndex;
+            slot->extent = { std::min(extent.width, mExtent.width), std::min(extent.height, mExtent.height) };
+        }
+    }
+
+    if (!slot) {
+        // Encoder is falling behind, drop the frame rather than waiting for it
+        ++mDroppedFrames;
+        return;
+    }
+
+    if (!mScreenshotPath.empty()) {
+        slot->path = std::move(mScreenshotPath);
+        slot->format = mScreenshotFormat;
+        mScreenshotPath.clear();
+    }
+    else {
+        slot->format = mContinuousFormat;
+        slot->path = mDirectory / std::format("frame_{:06}.{}", mFrameCounter++, mContinuousFormat == CaptureFormat::Png ? "png" : "raw");
+    }
+
+    vk::BufferImageCopy region {
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 },
+        .imageOffset = { 0, 0, 0 },
+        .imageExtent = { slot->extent.width, slot->extent.height, 1 }
+    };
+    cmd.copyImageToBuffer(image, layout, slot->buffer, region);
+
+    // Make the copy visible to the host once the frame's fence signals
+    vk::BufferMemoryBarrier2 barrier {
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eHost,
+        .dstAccessMask = vk::AccessFlagBits2::eHostRead,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = slot->buffer,
+        .offset = 0,
+        .size = static_cast<vk::DeviceSize>(slot->extent.width) * slot->extent.height * 4
+    };
+
+    vk::DependencyInfo dependencyInfo {
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &barrier
+    };
+    cmd.pipelineBarrier2(dependencyInfo);
+}
+
+void FrameCapture::Collect(uint32_t frameIndex) {
+    std::lock_guard lock(mMutex);
+
+    auto iter = std::ranges::find_if(mSlots, [frameIndex](const Slot& s) {
+        return s.state == SlotState::InFlight && s.frameIndex == frameIndex;
+    });
+    if (iter != mSlots.end()) {
+        submitForEncoding(static_cast<size_t>(std::distance(mSlots.begin(), iter)));
+    }
+}
+
+void FrameCapture::allocateSlots() {
+    // Prefer cached memory, reading back from uncached memory is very slow on the CPU
+    auto memProperties = mPhysicalDevice.getMemoryProperties();
+    vk::MemoryPropertyFlags properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCached;
+    bool hasCached = std::ranges::any_of(
+        std::span(memProperties.memoryTypes.data(), memProperties.memoryTypeCount),
+        [properties](const vk::MemoryType& type) { return (type.propertyFlags & properties) == properties; }
+    );
+    if (!hasCached) {
+        properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    }
+
+    // Enough buffers to keep every frame in flight copying while each encoder has one frame queued behind the one it works on
+    mSlots.resize(MAX_FRAMES_IN_FLIGHT + 2 * mEncoders.size());
+    for (auto& slot : mSlots) {
+        CreateBuffer(mDevice, mPhysicalDevice, mImageSize, vk::BufferUsageFlagBits::eTransferDst, properties, slot.buffer, slot.memory);
+        slot.mapped = slot.memory.mapMemory(0, mImageSize);
+    }
+
+    const uint32_t typeIndex = FindMemoryType(mPhysicalDevice, mSlots.front().buffer.getMemoryRequirements().memoryTypeBits, properties);
+    mCoherent = static_cast<bool>(memProperties.memoryTypes[typeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+void FrameCapture::submitForEncoding(size_t index) {
+    auto& slot = mSlots[index];
+    if (!mCoherent) {
+        mDevice.invalidateMappedMemoryRanges(vk::MappedMemoryRange { .memory = slot.memory, .offset = 0, .size = vk::WholeSize });
+    }
+
+    slot.state = SlotState::Encoding;
+    mEncodeQueue.push_back(index);
+    mCondition.notify_all();
+}
+
+void FrameCapture::flushInFlight() {
+    for (size_t i = 0; i < mSlots.size(); ++i) {
+        if (mSlots[i].state == SlotState::InFlight) {
+            submitForEncoding(i);
+        }
+    }
+}
+
+void FrameCapture::encoderLoop() {
+    std::unique_lock lock(mMutex);
+
+    while (true) {
+        mCondition.wait(lock, [this] { return mExit || !mEncodeQueue.empty(); });
+        if (mEncodeQueue.empty()) {
+            return;
+        }
+
+        size_t index = mEncodeQueue.front();
+        mEncodeQueue.pop_front();
+
+        // Slots in Encoding state are owned by the thread that dequeued them until released
+        lock.unlock();
+        encode(mSlots[index]);
+        lock.lock();
+
+        mSlots[index].state = SlotState::Free;
+        mCondition.notify_all();
+    }
+}
+
+void FrameCapture::encode(const Slot& slot) const {
+    const size_t pixelCount = static_cast<size_t>(slot.extent.width) * slot.extent.height;
+    const auto* src = static_cast<const uint8_t*>(slot.mapped);
+
+    // Convert to RGBA and force opaque alpha, the swapchain is presented with opaque composition
+    std::vector<uint8_t> rgba(pixelCount * 4);
+    const bool bgra = IsBgraFormat(mFormat);
+    for (size_t i = 0; i < pixelCount; ++i) {
+        rgba[i * 4 + 0] = src[i * 4 + (bgra ? 2 : 0)];
+        rgba[i * 4 + 1] = src[i * 4 + 1];
+        rgba[i * 4 + 2] = src[i * 4 + (bgra ? 0 : 2)];
+        rgba[i * 4 + 3] = 0xFF;
+    }
+
+    if (mEncodeSrgb) {
+        for (size_t i = 0; i < pixelCount * 4; ++i) {
+            rgba[i] = (i % 4 == 3) ? rgba[i] : EncodeSrgb(rgba[i]);
+        }
+    }
+
+    std::ofstream file(slot.path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "failed to open capture file: " << slot.path.string() << std::endl;
+        return;
+    }
+
+    if (slot.format == CaptureFormat::Png) {
+        auto png = EncodePng(rgba.data(), slot.extent.width, slot.extent.height);
+        file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    }
+    else {
+        file.write(reinterpret_cast<const char*>(rgba.data()), static_cast<std::streamsize>(rgba.size()));
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include <Graphics/Meshlet.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <unordered_map>
+
+#include <meshoptimizer.h>
+
+namespace VE::Gfx {
+
+// Weight of normal cone tightness against meshlet compactness when splitting
+constexpr float MESHLET_CONE_WEIGHT = 0.25f;
+
+// A group that cannot drop below this fraction of its triangles stays at the top of the hierarchy
+constexpr float MIN_SIMPLIFICATION_RATIO = 0.85f;
+
+struct LodBounds {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+    float error = 0.0f;
+};
+
+struct BuildCluster {
+    std::vector<uint32_t> indices;
+    meshopt_Bounds bounds = {};
+    LodBounds self;
+    LodBounds parent = { .error = FLT_MAX };
+};
+
+// -----------------------------------------------------------------------------------------------
+// Utility Functions
+// -----------------------------------------------------------------------------------------------
+std::vector<uint32_t> AppendMeshlets(std::span<const MeshVertex> vertices, std::span<const uint32_t> indices, std::vector<BuildCluster>& clusters) {
+    // Meshlets are built against only the vertices the indices reference. A simplified group touches a
+    // small part of the mesh and building against every vertex would cost O(vertex count) per group.
+    std::vector<uint32_t> localVertices(indices.begin(), indices.end());
+    std::ranges::sort(localVertices);
+    localVertices.erase(std::unique(localVertices.begin(), localVertices.end()), localVertices.end());
+
+    std::vector<uint32_t> localIndices(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        localIndices[i] = static_cast<uint32_t>(std::ranges::lower_bound(localVertices, indices[i]) - localVertices.begin());
+    }
+
+    std::vector<glm::vec3> localPositions;
+    localPositions.reserve(localVertices.size());
+    for (uint32_t vertex : localVertices) {
+        localPositions.push_back(vertices[vertex].position);
+    }
+    const float* positions = &localPositions[0].x;
+
+    const size_t maxMeshlets = meshopt_buildMeshletsBound(indices.size(), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+    std::vector<meshopt_Meshlet> meshlets(maxMeshlets);
+    std::vector<unsigned int> meshletVertices(maxMeshlets * MESHLET_MAX_VERTICES);
+    std::vector<unsigned char> meshletTriangles(maxMeshlets * MESHLET_MAX_TRIANGLES * 3);
+
+    const size_t meshletCount = meshopt_buildMeshlets(
+        meshlets.data(), meshletVertices.data(), meshletTriangles.data(),
+        localIndices.data(), localIndices.size(), positions, localPositions.size(), sizeof(glm::vec3),
+        MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, MESHLET_CONE_WEIGHT
+    );
+
+    std::vector<uint32_t> created;
+    for (size_t i = 0; i < meshletCount; ++i) {
+        const auto& meshlet = meshlets[i];
+
+        // Meshlet local indices are resolved so clusters index the shared vertex buffer directly
+        BuildCluster cluster;
+        cluster.indices.reserve(meshlet.triangle_count * 3);
+        for (uint32_t j = 0; j < meshlet.triangle_count * 3; ++j) {
+            cluster.indices.push_back(localVertices[meshletVertices[meshlet.vertex_offset + meshletTriangles[meshlet.triangle_offset + j]]]);
+        }
+
+        cluster.bounds = meshopt_computeMeshletBounds(
+            &meshletVertices[meshlet.vertex_offset], &meshletTriangles[meshlet.triangle_offset], meshlet.triangle_count,
+            positions, localPositions.size(), sizeof(glm::vec3)
+        );
+
+        created.push_back(static_cast<uint32_t>(clusters.size()));
+        clusters.push_back(std::move(cluster));
+    }
+
+    return created;
+}
+
+// Groups clusters sharing the most vertices, positions are compared so attribute seams do not split groups
+std::vector<std::vector<uint32_t>> GroupClusters(
+    const std::vector<BuildCluster>& clusters, const std::vector<uint32_t>& pending, const std::vector<uint32_t>& positionRemap
+) {
+    std::vector<std::vector<uint32_t>> clusterPositions(pending.size());
+    std::unordered_map<uint32_t, std::vector<uint32_t>> positionClusters;
+    for (uint32_t i = 0; i < pending.size(); ++i) {
+        auto& positions = clusterPositions[i];
+        for (uint32_t index : clusters[pending[i]].indices) {
+            positions.push_back(positionRemap[index]);
+        }
+        std::ranges::sort(positions);
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+        for (uint32_t position : positions) {
+            positionClusters[position].push_back(i);
+        }
+    }
+
+    std::vector<bool> grouped(pending.size(), false);
+    std::vector<std::vector<uint32_t>> groups;
+    for (uint32_t seed = 0; seed < pending.size(); ++seed) {
+        if (grouped[seed]) {
+            continue;
+        }
+
+        // Ungrouped neighbours and the number of positions they share with the group
+        std::unordered_map<uint32_t, uint32_t> shared;
+        auto addMember = [&](uint32_t member, std::vector<uint32_t>& group) {
+            grouped[member] = true;
+            group.push_back(member);
+            shared.erase(member);
+
+            for (uint32_t position : clusterPositions[member]) {
+                for (uint32_t neighbour : positionClusters[position]) {
+                    if (!grouped[neighbour]) {
+                        ++shared[neighbour];
+                    }
+                }
+            }
+        };
+
+        std::vector<uint32_t> group;
+        addMember(seed, group);
+
+        while (group.size() < MESHLET_GROUP_SIZE && !shared.empty()) {
+            auto best = shared.begin();
+            for (auto it = shared.begin(); it != shared.end(); ++it) {
+                if (it->second > best->second || (it->second == best->second && it->first < best->first)) {
+                    best = it;
+                }
+            }
+            addMember(best->first, group);
+        }
+
+        for (uint32_t& member : group) {
+            member = pending[member];
+        }
+        groups.push_back(std::move(group));
+    }
+
+    return groups;
+}
+
+// Conservative sphere around the children's spheres, with the largest of their errors
+LodBounds MergeLodBounds(const std::vector<BuildCluster>& clusters, const std::vector<uint32_t>& group) {
+    LodBounds merged;
+    for (uint32_t id : group) {
+        merged.center += clusters[id].self.center;
+    }
+    merged.center /= static_cast<float>(group.size());
+
+    for (uint32_t id : group) {
+        const auto& child = clusters[id].self;
+        merged.radius = std::max(merged.radius, glm::distance(merged.center, child.center) + child.radius);
+        merged.error = std::max(merged.error, child.error);
+    }
+
+    return merged;
+}
+
+MeshletHierarchy BuildMeshletHierarchy(std::span<const MeshVertex> vertices, std::span<const uint32_t> indices) {
+    MeshletHierarchy hierarchy;
+    if (vertices.empty() || indices.empty()) {
+        return hierarchy;
+    }
+
+    const float* positions = &vertices[0].position.x;
+
+    std::vector<uint32_t> positionRemap(vertices.size());
+    const meshopt_Stream positionStream = { positions, sizeof(float) * 3, sizeof(MeshVertex) };
+    meshopt_generateVertexRemapMulti(positionRemap.data(), nullptr, vertices.size(), vertices.size(), &positionStream, 1);
+
+    // The finest level is exact
+    std::vector<BuildCluster> clusters;
+    std::vector<uint32_t> pending = AppendMeshlets(vertices, indices, clusters);
+    for (uint32_t id : pending) {
+        auto& cluster = clusters[id];
+        cluster.self = {
+            .center = glm::vec3(cluster.bounds.center[0], cluster.bounds.center[1], cluster.bounds.center[2]),
+            .radius = cluster.bounds.radius,
+            .error = 0.0f
+        };
+    }
+    hierarchy.levelCount = 1;
+
+    while (pending.size() > 1) {
+        std::vector<uint32_t> next;
+
+        for (const auto& group : GroupClusters(clusters, pending, positionRemap)) {
+            std::vector<uint32_t> merged;
+            for (uint32_t id : group) {
+                merged.insert(merged.end(), clusters[id].indices.begin(), clusters[id].indices.end());
+            }
+
+            // The group border is locked so the result still matches the neighbouring groups
+            float error = 0.0f;
+            std::vector<uint32_t> simplified(merged.size());
+            simplified.resize(meshopt_simplify(
+                simplified.data(), merged.data(), merged.size(), positions, vertices.size(), sizeof(MeshVertex),
+                merged.size() / 6 * 3, FLT_MAX,
+                meshopt_SimplifyLockBorder | meshopt_SimplifySparse | meshopt_SimplifyErrorAbsolute, &error
+            ));
+
+            if (simplified.empty() || simplified.size() > merged.size() * MIN_SIMPLIFICATION_RATIO) {
+                continue;
+            }
+
+            // Errors only grow towards the root so the selection cut is unique
+            LodBounds groupBounds = MergeLodBounds(clusters, group);
+            groupBounds.error = std::max(groupBounds.error, error);
+
+            for (uint32_t id : group) {
+                clusters[id].parent = groupBounds;
+            }
+
+            for (uint32_t id : AppendMeshlets(vertices, simplified, clusters)) {
+                clusters[id].self = groupBounds;
+                next.push_back(id);
+            }
+        }
+
+        if (next.empty()) {
+            break;
+        }
+
+        pending = std::move(next);
+        ++hierarchy.levelCount;
+    }
+
+    hierarchy.clusters.reserve(clusters.size());
+    for (const auto& cluster : clusters) {
+        const auto& bounds = cluster.bounds;
+        hierarchy.clusters.push_back({
+            .center = glm::vec3(bounds.center[0], bounds.center[1], bounds.center[2]),
+            .radius = bounds.radius,
+            .coneApex = glm::vec3(bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]),
+            .coneCutoff = bounds.cone_cutoff,
+            .coneAxis = glm::vec3(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]),
+            .lodCenter = cluster.self.center,
+            .lodRadius = cluster.self.radius,
+            .parentLodCenter = cluster.parent.center,
+            .parentLodRadius = cluster.parent.radius,
+            .lodError = cluster.self.error,
+            .parentLodError = cluster.parent.error,
+            .firstIndex = static_cast<uint32_t>(hierarchy.indices.size()),
+            .indexCount = static_cast<uint32_t>(cluster.indices.size())
+        });
+
+        hierarchy.indices.insert(hierarchy.indices.end(), cluster.indices.begin(), cluster.indices.end());
+    }
+
+    return hierarchy;
+}
+
+}
\ No newline at end of file
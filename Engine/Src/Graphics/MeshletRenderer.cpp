@@ -0,0 +1,432 @@
+#include <Graphics/MeshletRenderer.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <Graphics/VulkanContext.h>
+#include <Graphics/VulkanUtils.h>
+
+namespace VE::Gfx {
+
+constexpr uint32_t CULL_GROUP_SIZE = 64;
+
+// Smallest allocation of the shared geometry buffers, avoids regrowing them for the first few small meshes
+constexpr vk::DeviceSize MIN_GEOMETRY_BUFFER_SIZE = 1024 * 1024;
+
+// Matches the std140 layout of CullData in meshlet_cull.slang
+struct CullData {
+    glm::vec4 frustum[6];
+    glm::vec4 cameraPosition;
+    glm::vec4 lod;              // projection scale in pixels, error threshold in pixels, near
+    glm::uvec4 counts;          // cluster count
+};
+
+// Matches the std430 layout of MeshInstance in meshlet_common.slang
+struct MeshInstance {
+    glm::mat4 model;
+    glm::vec4 scale;            // x is the largest axis scale
+};
+
+// -----------------------------------------------------------------------------------------------
+// MeshletRenderer
+// -----------------------------------------------------------------------------------------------
+MeshletRenderer::MeshletRenderer(
+    const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice,
+    const vk::raii::Queue& queue, uint32_t queueFamilyIndex, const PipelineLibrary& pipelines,
+    ResidencyManager& residency, vk::DescriptorSetLayout lightingSetLayout, vk::Format colorFormat, vk::Format depthFormat
+) : mDevice(device), mPhysicalDevice(physicalDevice), mResidency(residency) {
+    ComputePassDesc cullDesc {
+        .code = pipelines.GetShader("Assets/Shader/meshlet_cull.spv"),
+        .entryPoint = "compMain",
+        .bindings = {
+            { .binding = 0, .descriptorType = vk::DescriptorType::eUniformBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute },
+            { .binding = 1, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute },
+            { .binding = 2, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute },
+            { .binding = 3, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute },
+            { .binding = 4, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute }
+        },
+        .pipelineCache = &pipelines.GetPipelineCache()
+    };
+    mCullPass = std::make_unique<ComputePass>(mDevice, queue, queueFamilyIndex, cullDesc);
+
+    mFrames.resize(MAX_FRAMES_IN_FLIGHT);
+    for (auto& frame : mFrames) {
+        CreateBuffer(
+            mDevice, mPhysicalDevice, sizeof(CullData), vk::BufferUsageFlagBits::eUniformBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+            frame.cullData, frame.cullDataMemory
+        );
+        frame.cullDataMapped = frame.cullDataMemory.mapMemory(0, sizeof(CullData));
+
+        CreateBuffer(
+            mDevice, mPhysicalDevice, sizeof(uint32_t),
+            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst,
+            vk::MemoryPropertyFlagBits::eDeviceLocal, frame.drawCount, frame.drawCountMemory
+        );
+    }
+
+    createDescriptorSets();
+    createPipeline(pipelines, lightingSetLayout, colorFormat, depthFormat);
+}
+
+MeshletRenderer::~MeshletRenderer() {
+    mResidency.DestroyBuffer(mVertexBuffer);
+    mResidency.DestroyBuffer(mIndexBuffer);
+    mResidency.DestroyBuffer(mClusterBuffer);
+}
+
+MeshHandle MeshletRenderer::AddMesh(std::span<const MeshVertex> vertices, std::span<const uint32_t> indices, const glm::mat4& transform) {
+    if (vertices.empty() || indices.empty()) {
+        throw std::runtime_error("failed to add mesh without triangles!");
+    }
+
+    const MeshletHierarchy hierarchy = BuildMeshletHierarchy(vertices, indices);
+
+    const auto mesh = static_cast<MeshHandle>(mTransforms.size());
+
+    std::vector<MeshVertex> meshVertices(vertices.begin(), vertices.end());
+    for (auto& vertex : meshVertices) {
+        vertex.meshIndex = mesh;
+    }
+
+    std::vector<uint32_t> meshIndices(hierarchy.indices);
+    for (uint32_t& index : meshIndices) {
+        index += mVertexCount;
+    }
+
+    std::vector<MeshCluster> meshClusters(hierarchy.clusters);
+    for (auto& cluster : meshClusters) {
+        cluster.meshIndex = mesh;
+        cluster.firstIndex += mIndexCount;
+    }
+
+    // Only the new mesh is uploaded, frames in flight never read past the previous counts
+    appendBuffer(
+        mVertexBuffer, vk::BufferUsageFlagBits::eStorageBuffer,
+        mVertexCount * sizeof(MeshVertex), meshVertices.data(), meshVertices.size() * sizeof(MeshVertex)
+    );
+    appendBuffer(
+        mIndexBuffer, vk::BufferUsageFlagBits::eIndexBuffer,
+        mIndexCount * sizeof(uint32_t), meshIndices.data(), meshIndices.size() * sizeof(uint32_t)
+    );
+    appendBuffer(
+        mClusterBuffer, vk::BufferUsageFlagBits::eStorageBuffer,
+        mClusterCount * sizeof(MeshCluster), meshClusters.data(), meshClusters.size() * sizeof(MeshCluster)
+    );
+
+    mVertexCount += static_cast<uint32_t>(meshVertices.size());
+    mIndexCount += static_cast<uint32_t>(meshIndices.size());
+    mClusterCount += static_cast<uint32_t>(meshClusters.size());
+    mTransforms.push_back(transform);
+
+    ++mStatistics.meshCount;
+    mStatistics.clusterCount += static_cast<uint32_t>(hierarchy.clusters.size());
+    mStatistics.triangleCount += static_cast<uint32_t>(indices.size() / 3);
+
+    return mesh;
+}
+
+void MeshletRenderer::SetTransform(MeshHandle mesh, const glm::mat4& transform) {
+    mTransforms.at(mesh) = transform;
+}
+
+void MeshletRenderer::Update(uint32_t frameIndex, const Camera& camera, vk::Extent2D renderExtent) {
+    auto& frame = mFrames[frameIndex];
+    frame.clusterCount = mClusterCount;
+    if (mClusterCount == 0) {
+        return;
+    }
+
+    bool rebind = false;
+    if (frame.instanceCapacity < mTransforms.size()) {
+        frame.instanceCapacity = std::max(static_cast<uint32_t>(mTransforms.size()), frame.instanceCapacity * 2);
+
+        const vk::DeviceSize instancesSize = frame.instanceCapacity * sizeof(MeshInstance);
+        CreateBuffer(
+            mDevice, mPhysicalDevice, instancesSize, vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+            frame.instances, frame.instancesMemory
+        );
+        frame.instancesMapped = frame.instancesMemory.mapMemory(0, instancesSize);
+        rebind = true;
+    }
+
+    if (frame.drawCapacity < mClusterCount) {
+        frame.drawCapacity = std::max(mClusterCount, frame.drawCapacity * 2);
+
+        CreateBuffer(
+            mDevice, mPhysicalDevice, frame.drawCapacity * sizeof(vk::DrawIndexedIndirectCommand),
+            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+            vk::MemoryPropertyFlagBits::eDeviceLocal, frame.draws, frame.drawsMemory
+        );
+        rebind = true;
+    }
+
+    if (rebind
+        || mResidency.Use(mVertexBuffer) != frame.boundVertices
+        || mResidency.Use(mIndexBuffer) != frame.boundIndices
+        || mResidency.Use(mClusterBuffer) != frame.boundClusters) {
+        writeDescriptorSets(frameIndex);
+    }
+
+    const glm::mat4 proj = camera.GetProjection(static_cast<float>(renderExtent.width) / static_cast<float>(renderExtent.height));
+    const glm::mat4 rows = glm::transpose(proj * camera.view);
+
+    // Frustum planes from the rows of the view-projection matrix, depth is in [0, 1]
+    CullData cullData {
+        .frustum = {
+            rows[3] + rows[0],
+            rows[3] - rows[0],
+            rows[3] + rows[1],
+            rows[3] - rows[1],
+            rows[2],
+            rows[3] - rows[2]
+        },
+        .cameraPosition = glm::vec4(glm::vec3(glm::inverse(camera.view)[3]), 1.0f),
+        .lod = { std::abs(proj[1][1]) * 0.5f * static_cast<float>(renderExtent.height), mErrorThreshold, camera.zNear, 0.0f },
+        .counts = { mClusterCount, 0, 0, 0 }
+    };
+
+    for (auto& plane : cullData.frustum) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    std::memcpy(frame.cullDataMapped, &cullData, sizeof(cullData));
+
+    auto* instances = static_cast<MeshInstance*>(frame.instancesMapped);
+    for (size_t i = 0; i < mTransforms.size(); ++i) {
+        const glm::mat4& model = mTransforms[i];
+        const float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+        instances[i] = { .model = model, .scale = glm::vec4(scale, 0.0f, 0.0f, 0.0f) };
+    }
+}
+
+void MeshletRenderer::RecordCulling(const vk::raii::CommandBuffer& cmd, uint32_t frameIndex) const {
+    const auto& frame = mFrames[frameIndex];
+    if (frame.clusterCount == 0) {
+        return;
+    }
+
+    cmd.fillBuffer(frame.drawCount, 0, sizeof(uint32_t), 0);
+
+    vk::BufferMemoryBarrier2 clearBarrier {
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = frame.drawCount,
+        .offset = 0,
+        .size = sizeof(uint32_t)
+    };
+    cmd.pipelineBarrier2({ .bufferMemoryBarrierCount = 1, .pBufferMemoryBarriers = &clearBarrier });
+
+    mCullPass->Bind(cmd, frameIndex);
+    cmd.dispatch((frame.clusterCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    // Draws and their count are consumed as indirect arguments
+    vk::MemoryBarrier2 cullBarrier {
+        .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eDrawIndirect,
+        .dstAccessMask = vk::AccessFlagBits2::eIndirectCommandRead
+    };
+    cmd.pipelineBarrier2({ .memoryBarrierCount = 1, .pMemoryBarriers = &cullBarrier });
+}
+
+void MeshletRenderer::RecordDraw(const vk::raii::CommandBuffer& cmd, uint32_t frameIndex, vk::DescriptorSet lightingSet) const {
+    const auto& frame = mFrames[frameIndex];
+    if (frame.clusterCount == 0) {
+        return;
+    }
+
+    cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, mPipeline);
+    cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, mPipelineLayout, 0, { lightingSet, *mDescriptorSets[frameIndex] }, {});
+    cmd.bindIndexBuffer(frame.boundIndices, 0, vk::IndexType::eUint32);
+    cmd.drawIndexedIndirectCount(
+        frame.draws, 0, frame.drawCount, 0,
+        frame.clusterCount, sizeof(vk::DrawIndexedIndirectCommand)
+    );
+}
+
+void MeshletRenderer::createPipeline(const PipelineLibrary& pipelines, vk::DescriptorSetLayout lightingSetLayout, vk::Format colorFormat, vk::Format depthFormat) {
+    const std::vector<char>& code = pipelines.GetShader("Assets/Shader/mesh.spv");
+    vk::ShaderModuleCreateInfo smCreateInfo {
+        .codeSize = code.size() * sizeof(char),
+        .pCode = reinterpret_cast<const uint32_t*>(code.data())
+    };
+    vk::raii::ShaderModule shaderModule(mDevice, smCreateInfo);
+
+    vk::PipelineShaderStageCreateInfo shaderStages[] = {
+        { .stage = vk::ShaderStageFlagBits::eVertex, .module = shaderModule, .pName = "vertMain" },
+        { .stage = vk::ShaderStageFlagBits::eFragment, .module = shaderModule, .pName = "fragMain" }
+    };
+
+    std::vector dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
+    vk::PipelineDynamicStateCreateInfo dynamicState {
+        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+        .pDynamicStates = dynamicStates.data()
+    };
+
+    // Vertices are pulled from a storage buffer
+    vk::PipelineVertexInputStateCreateInfo vertexInputInfo;
+
+    vk::PipelineInputAssemblyStateCreateInfo inputAssembly {
+        .topology = vk::PrimitiveTopology::eTriangleList
+    };
+
+    vk::PipelineViewportStateCreateInfo viewportState {
+        .viewportCount = 1,
+        .scissorCount = 1
+    };
+
+    vk::PipelineRasterizationStateCreateInfo rasterizer {
+        .depthClampEnable = vk::False,
+        .rasterizerDiscardEnable = vk::False,
+        .polygonMode = vk::PolygonMode::eFill,
+        .cullMode = vk::CullModeFlagBits::eBack,
+        .frontFace = vk::FrontFace::eCounterClockwise,
+        .depthBiasEnable = vk::False,
+        .lineWidth = 1.0f
+    };
+
+    vk::PipelineMultisampleStateCreateInfo multisampling {
+        .rasterizationSamples = vk::SampleCountFlagBits::e1,
+        .sampleShadingEnable = vk::False
+    };
+
+    vk::PipelineDepthStencilStateCreateInfo depthStencil {
+        .depthTestEnable = vk::True,
+        .depthWriteEnable = vk::True,
+        .depthCompareOp = vk::CompareOp::eLess
+    };
+
+    vk::PipelineColorBlendAttachmentState colorBlendAttachment {
+        .blendEnable = vk::False,
+        .colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
+    };
+
+    vk::PipelineColorBlendStateCreateInfo colorBlending {
+        .logicOpEnable = vk::False,
+        .logicOp = vk::LogicOp::eCopy,
+        .attachmentCount = 1,
+        .pAttachments = &colorBlendAttachment
+    };
+
+    // Set 0 is the clustered lighting shared with the other forward passes
+    const std::array setLayouts = { lightingSetLayout, *mDescriptorSetLayout };
+    vk::PipelineLayoutCreateInfo pipelineLayoutInfo {
+        .setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+        .pSetLayouts = setLayouts.data(),
+        .pushConstantRangeCount = 0
+    };
+    mPipelineLayout = vk::raii::PipelineLayout(mDevice, pipelineLayoutInfo);
+
+    vk::PipelineRenderingCreateInfo pipelineRenderingCreateInfo {
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &colorFormat,
+        .depthAttachmentFormat = depthFormat
+    };
+
+    vk::GraphicsPipelineCreateInfo pipelineInfo {
+        .pNext = &pipelineRenderingCreateInfo,
+        .stageCount = 2,
+        .pStages = shaderStages,
+        .pVertexInputState = &vertexInputInfo,
+        .pInputAssemblyState = &inputAssembly,
+        .pViewportState = &viewportState,
+        .pRasterizationState = &rasterizer,
+        .pMultisampleState = &multisampling,
+        .pDepthStencilState = &depthStencil,
+        .pColorBlendState = &colorBlending,
+        .pDynamicState = &dynamicState,
+        .layout = mPipelineLayout,
+        .renderPass = nullptr
+    };
+
+    mPipeline = vk::raii::Pipeline(mDevice, pipelines.GetPipelineCache(), pipelineInfo);
+}
+
+void MeshletRenderer::createDescriptorSets() {
+    std::array bindings = {
+        vk::DescriptorSetLayoutBinding { .binding = 0, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eVertex },
+        vk::DescriptorSetLayoutBinding { .binding = 1, .descriptorType = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eVertex }
+    };
+
+    vk::DescriptorSetLayoutCreateInfo layoutInfo {
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
+    };
+    mDescriptorSetLayout = vk::raii::DescriptorSetLayout(mDevice, layoutInfo);
+
+    vk::DescriptorPoolSize poolSize {
+        .type = vk::DescriptorType::eStorageBuffer,
+        .descriptorCount = static_cast<uint32_t>(bindings.size()) * MAX_FRAMES_IN_FLIGHT
+    };
+
+    vk::DescriptorPoolCreateInfo poolInfo {
+        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = MAX_FRAMES_IN_FLIGHT,
+        .poolSizeCount = 1,
+        .pPoolSizes = &poolSize
+    };
+    mDescriptorPool = vk::raii::DescriptorPool(mDevice, poolInfo);
+
+    std::vector<vk::DescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, *mDescriptorSetLayout);
+    vk::DescriptorSetAllocateInfo allocInfo {
+        .descriptorPool = mDescriptorPool,
+        .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
+        .pSetLayouts = layouts.data()
+    };
+    mDescriptorSets = mDevice.allocateDescriptorSets(allocInfo);
+}
+
+void MeshletRenderer::writeDescriptorSets(uint32_t frameIndex) {
+    auto& frame = mFrames[frameIndex];
+    frame.boundVertices = mResidency.Use(mVertexBuffer);
+    frame.boundIndices = mResidency.Use(mIndexBuffer);
+    frame.boundClusters = mResidency.Use(mClusterBuffer);
+
+    mCullPass->WriteUniformBuffer(frameIndex, 0, frame.cullData);
+    mCullPass->WriteStorageBuffer(frameIndex, 1, frame.boundClusters);
+    mCullPass->WriteStorageBuffer(frameIndex, 2, frame.instances);
+    mCullPass->WriteStorageBuffer(frameIndex, 3, frame.draws);
+    mCullPass->WriteStorageBuffer(frameIndex, 4, frame.drawCount);
+
+    const std::array bufferInfos = {
+        vk::DescriptorBufferInfo { .buffer = frame.boundVertices, .offset = 0, .range = vk::WholeSize },
+        vk::DescriptorBufferInfo { .buffer = frame.instances, .offset = 0, .range = vk::WholeSize }
+    };
+
+    std::vector<vk::WriteDescriptorSet> writes;
+    for (uint32_t binding = 0; binding < bufferInfos.size(); ++binding) {
+        writes.push_back({
+            .dstSet = mDescriptorSets[frameIndex],
+            .dstBinding = binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &bufferInfos[binding]
+        });
+    }
+    mDevice.updateDescriptorSets(writes, {});
+}
+
+void MeshletRenderer::appendBuffer(StreamableBufferHandle& buffer, vk::BufferUsageFlags usage, vk::DeviceSize offset, const void* data, vk::DeviceSize size) {
+    const vk::DeviceSize required = offset + size;
+    if (!buffer) {
+        buffer = mResidency.CreateBuffer(std::max(required, MIN_GEOMETRY_BUFFER_SIZE), usage);
+    }
+    else if (required > mResidency.GetSize(buffer)) {
+        // Doubling keeps the bytes copied while loading many meshes linear in the final size
+        mResidency.ResizeBuffer(buffer, std::max(required, 2 * mResidency.GetSize(buffer)));
+    }
+
+    mResidency.WriteBuffer(buffer, offset, data, size);
+}
+
+}
\ No newline at end of file
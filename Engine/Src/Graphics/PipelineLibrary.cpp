@@ -0,0 +1,107 @@
+#include <Graphics/PipelineLibrary.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <Graphics/VulkanUtils.h>
+
+namespace VE::Gfx {
+
+// -----------------------------------------------------------------------------------------------
+// PipelineLibrary
+// -----------------------------------------------------------------------------------------------
+void PipelineLibrary::LoadShaders(const std::vector<std::string>& paths) {
+    for (const auto& path : paths) {
+        mShaders[path] = ReadFile(path);
+    }
+}
+
+void PipelineLibrary::LoadCacheData(const std::filesystem::path& directory) {
+    // A missing cache directory is expected on the first run
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (!entry.is_regular_file(error)) {
+            continue;
+        }
+
+        std::ifstream file(entry.path(), std::ios::ate | std::ios::binary);
+        if (!file.is_open()) {
+            continue;
+        }
+
+        const auto size = static_cast<size_t>(file.tellg());
+        if (size < sizeof(vk::PipelineCacheHeaderVersionOne)) {
+            continue;
+        }
+
+        // Only the header is read from files that are not a version one pipeline cache
+        CacheFile cache;
+        file.seekg(0, std::ios::beg);
+        file.read(reinterpret_cast<char*>(&cache.header), sizeof(cache.header));
+        if (!file || cache.header.headerVersion != vk::PipelineCacheHeaderVersion::eOne || cache.header.headerSize < sizeof(cache.header)) {
+            continue;
+        }
+
+        cache.data.resize(size);
+        file.seekg(0, std::ios::beg);
+        file.read(cache.data.data(), static_cast<std::streamsize>(size));
+        if (file) {
+            mCacheFiles.push_back(std::move(cache));
+        }
+    }
+}
+
+void PipelineLibrary::CreatePipelineCache(const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice) {
+    const auto properties = physicalDevice.getProperties();
+
+    // Data written by another device or driver version is discarded
+    const auto cache = std::ranges::find_if(mCacheFiles, [&properties](const CacheFile& file) {
+        return file.header.vendorID == properties.vendorID
+            && file.header.deviceID == properties.deviceID
+            && std::memcmp(file.header.pipelineCacheUUID.data(), properties.pipelineCacheUUID.data(), vk::UuidSize) == 0;
+    });
+    const bool warm = cache != mCacheFiles.end();
+
+    vk::PipelineCacheCreateInfo cacheInfo {
+        .initialDataSize = warm ? cache->data.size() : 0,
+        .pInitialData = warm ? cache->data.data() : nullptr
+    };
+    mPipelineCache = vk::raii::PipelineCache(device, cacheInfo);
+
+    mCacheFiles.clear();
+    mCacheFiles.shrink_to_fit();
+}
+
+void PipelineLibrary::SaveCacheData(const std::filesystem::path& path) const {
+    if (!*mPipelineCache) {
+        return;
+    }
+
+    const std::vector<uint8_t> data = mPipelineCache.getData();
+
+    // The cache directory does not exist before the first run, a failure shows up when opening the file
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "failed to write pipeline cache: " << path.string() << std::endl;
+        return;
+    }
+
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+const std::vector<char>& PipelineLibrary::GetShader(const std::string& path) const {
+    const auto it = mShaders.find(path);
+    if (it == mShaders.end()) {
+        throw std::runtime_error("shader was not loaded: " + path);
+    }
+
+    return it->second;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,458 @@
+#include <Graphics/ResidencyManager.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <Graphics/VulkanContext.h>
+
+namespace VE::Gfx {
+
+// Fractions of the device-local budget
+constexpr double EVICT_THRESHOLD = 0.90;        // Start evicting above this
+constexpr double EVICT_TARGET = 0.80;           // Evict until below this
+constexpr double PROMOTE_THRESHOLD = 0.70;      // Promote only below this
+constexpr double PROMOTE_TARGET = 0.80;         // Never promote past this
+
+// Spec recommendation when the real budget is unknown
+constexpr double ESTIMATED_BUDGET = 0.80;
+
+// Limits the copy bandwidth spent on promotion per frame
+constexpr vk::DeviceSize MAX_PROMOTION_PER_FRAME = 64ull * 1024 * 1024;
+
+// -----------------------------------------------------------------------------------------------
+// ResidencyManager
+// -----------------------------------------------------------------------------------------------
+ResidencyManager::ResidencyManager(
+    const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice,
+    const vk::raii::Queue& queue, uint32_t queueFamilyIndex, bool memoryBudget
+) : mDevice(device), mPhysicalDevice(physicalDevice), mQueue(queue), mMemoryBudget(memoryBudget) {
+    mMemoryProperties = mPhysicalDevice.getMemoryProperties();
+
+    // Budgets are tracked for the largest device-local heap, a small host-visible BAR heap is not where VRAM lives
+    vk::DeviceSize deviceHeapSize = 0;
+    for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; ++i) {
+        const auto& type = mMemoryProperties.memoryTypes[i];
+        const vk::DeviceSize heapSize = mMemoryProperties.memoryHeaps[type.heapIndex].size;
+        if ((type.propertyFlags & vk::MemoryPropertyFlagBits::eDeviceLocal) && heapSize > deviceHeapSize) {
+            mDeviceHeap = type.heapIndex;
+            deviceHeapSize = heapSize;
+        }
+    }
+
+    const auto deviceMemoryType = findMemoryType(~0u, true);
+    const auto hostMemoryType = findMemoryType(~0u, false);
+    if (!deviceMemoryType || !hostMemoryType) {
+        throw std::runtime_error("failed to find suitable memory type!");
+    }
+    mDeviceMemoryType = *deviceMemoryType;
+    mHostMemoryType = *hostMemoryType;
+
+    // On unified memory architectures both types share a heap and demotion gains nothing
+    mCanDemote = mMemoryProperties.memoryTypes[mHostMemoryType].heapIndex != mDeviceHeap;
+
+    mTrackedUsage.resize(mMemoryProperties.memoryHeapCount, 0);
+    mStatistics.heaps.resize(mMemoryProperties.memoryHeapCount);
+    mStatistics.budgetExtension = mMemoryBudget;
+
+    vk::CommandPoolCreateInfo poolInfo {
+        .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+        .queueFamilyIndex = queueFamilyIndex
+    };
+    mCommandPool = vk::raii::CommandPool(mDevice, poolInfo);
+
+    vk::CommandBufferAllocateInfo allocInfo {
+        .commandPool = mCommandPool,
+        .level = vk::CommandBufferLevel::ePrimary,
+        .commandBufferCount = MAX_FRAMES_IN_FLIGHT
+    };
+    mCommandBuffers = vk::raii::CommandBuffers(mDevice, allocInfo);
+
+    queryBudget();
+}
+
+StreamableBufferHandle ResidencyManager::CreateBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, const void* data) {
+    Resource resource {
+        .size = size,
+        .usage = usage | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst,
+        .lastUsedFrame = mFrameCount
+    };
+    resource.resident = allocateStreamable(size, resource.usage, resource.allocation);
+
+    const StreamableBufferHandle handle = mNextHandle++;
+    mResources.emplace(handle, std::move(resource));
+
+    if (data) {
+        WriteBuffer(handle, 0, data, size);
+    }
+
+    return handle;
+}
+
+void ResidencyManager::DestroyBuffer(StreamableBufferHandle handle) {
+    auto iter = mResources.find(handle);
+    if (iter == mResources.end()) {
+        return;
+    }
+
+    retire(std::move(iter->second.allocation));
+    mResources.erase(iter);
+}
+
+void ResidencyManager::ResizeBuffer(StreamableBufferHandle handle, vk::DeviceSize size) {
+    auto& resource = mResources.at(handle);
+    if (size == resource.size) {
+        return;
+    }
+
+    Allocation allocation;
+    const bool resident = allocateStreamable(size, resource.usage, allocation);
+
+    mPendingCopies.push_back({ .src = resource.allocation.buffer, .dst = allocation.buffer, .size = std::min(size, resource.size) });
+
+    retire(std::move(resource.allocation));
+    resource.allocation = std::move(allocation);
+    resource.size = size;
+    resource.resident = resident;
+}
+
+void ResidencyManager::WriteBuffer(StreamableBufferHandle handle, vk::DeviceSize offset, const void* data, vk::DeviceSize size) {
+    auto& resource = mResources.at(handle);
+    if (size == 0) {
+        return;
+    }
+    if (offset + size > resource.size) {
+        throw std::runtime_error("streamable buffer write out of range!");
+    }
+
+    // Device-local memory that is also host-visible (unified memory, resizable BAR) and demoted buffers
+    // are written directly, unless a queued copy into the buffer would land on top of the write
+    constexpr vk::MemoryPropertyFlags mappable = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    const auto memoryFlags = mMemoryProperties.memoryTypes[resource.allocation.memoryType].propertyFlags;
+    const vk::Buffer buffer = resource.allocation.buffer;
+    const bool copyPending = std::ranges::any_of(mPendingCopies, [buffer](const PendingCopy& copy) { return copy.dst == buffer; });
+
+    if ((memoryFlags & mappable) == mappable && !copyPending) {
+        void* mapped = resource.allocation.memory.mapMemory(offset, size);
+        std::memcpy(mapped, data, size);
+        resource.allocation.memory.unmapMemory();
+        return;
+    }
+
+    Allocation staging;
+    if (!allocate(size, vk::BufferUsageFlagBits::eTransferSrc, false, staging)) {
+        throw std::runtime_error("failed to allocate staging buffer!");
+    }
+
+    void* mapped = staging.memory.mapMemory(0, size);
+    std::memcpy(mapped, data, size);
+    staging.memory.unmapMemory();
+
+    mPendingCopies.push_back({ .src = staging.buffer, .dst = buffer, .dstOffset = offset, .size = size });
+    retire(std::move(staging));
+}
+
+vk::DeviceSize ResidencyManager::GetSize(StreamableBufferHandle handle) const {
+    return mResources.at(handle).size;
+}
+
+vk::Buffer ResidencyManager::Use(StreamableBufferHandle handle) {
+    auto& resource = mResources.at(handle);
+    resource.lastUsedFrame = mFrameCount;
+    return resource.allocation.buffer;
+}
+
+void ResidencyManager::Update(uint32_t frameIndex) {
+    ++mFrameCount;
+
+    releaseRetired();
+    queryBudget();
+
+    if (mCanDemote) {
+        const auto budget = static_cast<double>(mStatistics.heaps[mDeviceHeap].budget);
+        const auto usage = static_cast<double>(projectedUsage());
+
+        if (usage > budget * EVICT_THRESHOLD) {
+            evict(static_cast<vk::DeviceSize>(budget * EVICT_TARGET));
+        }
+        else if (usage < budget * PROMOTE_THRESHOLD) {
+            promote(static_cast<vk::DeviceSize>(budget * PROMOTE_TARGET));
+        }
+    }
+
+    submitCopies(frameIndex);
+
+    mStatistics.residentBuffers = 0;
+    mStatistics.demotedBuffers = 0;
+    for (const auto& [handle, resource] : mResources) {
+        ++(resource.resident ? mStatistics.residentBuffers : mStatistics.demotedBuffers);
+    }
+}
+
+std::optional<uint32_t> ResidencyManager::findMemoryType(uint32_t typeFilter, bool deviceLocal) const {
+    constexpr vk::MemoryPropertyFlags hostFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+    // Device-local memory has to come from the tracked heap and is preferably not host-visible,
+    // host memory preferably comes from any other heap
+    std::optional<uint32_t> memoryType;
+    int bestRank = 0;
+    for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; ++i) {
+        const auto& type = mMemoryProperties.memoryTypes[i];
+        if (!(typeFilter & (1u << i))) {
+            continue;
+        }
+
+        int rank = 0;
+        if (deviceLocal) {
+            if ((type.propertyFlags & vk::MemoryPropertyFlagBits::eDeviceLocal) && type.heapIndex == mDeviceHeap) {
+                rank = (type.propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) ? 1 : 2;
+            }
+        }
+        else if ((type.propertyFlags & hostFlags) == hostFlags) {
+            rank = type.heapIndex != mDeviceHeap ? 2 : 1;
+        }
+
+        if (rank > bestRank) {
+            memoryType = i;
+            bestRank = rank;
+        }
+    }
+
+    return memoryType;
+}
+
+bool ResidencyManager::allocate(vk::DeviceSize size, vk::BufferUsageFlags usage, bool deviceLocal, Allocation& allocation) {
+    vk::BufferCreateInfo bufferInfo {
+        .size = size,
+        .usage = usage,
+        .sharingMode = vk::SharingMode::eExclusive
+    };
+    vk::raii::Buffer buffer(mDevice, bufferInfo);
+
+    const vk::MemoryRequirements memRequirements = buffer.getMemoryRequirements();
+    const auto memoryType = findMemoryType(memRequirements.memoryTypeBits, deviceLocal);
+    if (!memoryType) {
+        return false;
+    }
+
+    try {
+        vk::MemoryAllocateInfo allocInfo {
+            .allocationSize = memRequirements.size,
+            .memoryTypeIndex = *memoryType
+        };
+        allocation.memory = vk::raii::DeviceMemory(mDevice, allocInfo);
+    }
+    catch (const vk::OutOfDeviceMemoryError&) {
+        return false;
+    }
+    catch (const vk::OutOfHostMemoryError&) {
+        return false;
+    }
+
+    buffer.bindMemory(*allocation.memory, 0);
+    allocation.buffer = std::move(buffer);
+    allocation.size = memRequirements.size;
+    allocation.memoryType = *memoryType;
+    allocation.heapIndex = mMemoryProperties.memoryTypes[*memoryType].heapIndex;
+
+    mTrackedUsage[allocation.heapIndex] += allocation.size;
+
+    // Reported usage only catches up on the next query, keep the projection in sync until then
+    mStatistics.heaps[allocation.heapIndex].usage += allocation.size;
+    return true;
+}
+
+bool ResidencyManager::allocateStreamable(vk::DeviceSize size, vk::BufferUsageFlags usage, Allocation& allocation) {
+    // Allocations that would push the heap over budget start out in host memory
+    const auto& heap = mStatistics.heaps[mDeviceHeap];
+    const bool fits = !mCanDemote || projectedUsage() + size <= static_cast<vk::DeviceSize>(heap.budget * EVICT_THRESHOLD);
+
+    if (fits && allocate(size, usage, true, allocation)) {
+        return true;
+    }
+
+    if (!allocate(size, usage, false, allocation)) {
+        throw std::runtime_error("failed to allocate streamable buffer!");
+    }
+    return false;
+}
+
+void ResidencyManager::retire(Allocation&& allocation) {
+    if (allocation.heapIndex == mDeviceHeap) {
+        mPendingRelease += allocation.size;
+    }
+
+    mRetired.push_back({ .allocation = std::move(allocation), .frame = mFrameCount });
+}
+
+void ResidencyManager::releaseRetired() {
+    // Work submitted up to the retiring frame has finished once MAX_FRAMES_IN_FLIGHT frames passed
+    auto released = std::ranges::partition(mRetired, [this](const RetiredAllocation& retired) {
+        return mFrameCount <= retired.frame + MAX_FRAMES_IN_FLIGHT;
+    });
+
+    for (auto& retired : released) {
+        mTrackedUsage[retired.allocation.heapIndex] -= retired.allocation.size;
+        if (retired.allocation.heapIndex == mDeviceHeap) {
+            mPendingRelease -= retired.allocation.size;
+        }
+    }
+    mRetired.erase(released.begin(), released.end());
+}
+
+void ResidencyManager::queryBudget() {
+    if (mMemoryBudget) {
+        auto chain = mPhysicalDevice.getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2, vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+        const auto& properties = chain.get<vk::PhysicalDeviceMemoryProperties2>().memoryProperties;
+        const auto& budget = chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+
+        for (uint32_t i = 0; i < properties.memoryHeapCount; ++i) {
+            auto& heap = mStatistics.heaps[i];
+            heap.size = properties.memoryHeaps[i].size;
+            heap.budget = budget.heapBudget[i];
+            heap.usage = budget.heapUsage[i];
+            heap.deviceLocal = static_cast<bool>(properties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+        }
+    }
+    else {
+        // Only allocations made here are known, so the usage is a lower bound
+        for (uint32_t i = 0; i < mMemoryProperties.memoryHeapCount; ++i) {
+            auto& heap = mStatistics.heaps[i];
+            heap.size = mMemoryProperties.memoryHeaps[i].size;
+            heap.budget = static_cast<vk::DeviceSize>(heap.size * ESTIMATED_BUDGET);
+            heap.usage = mTrackedUsage[i];
+            heap.deviceLocal = static_cast<bool>(mMemoryProperties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+        }
+    }
+}
+
+vk::DeviceSize ResidencyManager::projectedUsage() const {
+    // Retired allocations are still counted by the driver until they are released
+    const vk::DeviceSize usage = mStatistics.heaps[mDeviceHeap].usage;
+    return usage > mPendingRelease ? usage - mPendingRelease : 0;
+}
+
+void ResidencyManager::move(Resource& resource, bool toDevice) {
+    Allocation allocation;
+    if (!allocate(resource.size, resource.usage, toDevice, allocation)) {
+        return;
+    }
+
+    mPendingCopies.push_back({ .src = resource.allocation.buffer, .dst = allocation.buffer, .size = resource.size });
+
+    retire(std::move(resource.allocation));
+    resource.allocation = std::move(allocation);
+    resource.resident = toDevice;
+}
+
+void ResidencyManager::evict(vk::DeviceSize target) {
+    std::vector<Resource*> candidates;
+    for (auto& [handle, resource] : mResources) {
+        if (resource.resident) {
+            candidates.push_back(&resource);
+        }
+    }
+
+    std::ranges::sort(candidates, {}, &Resource::lastUsedFrame);
+
+    for (Resource* resource : candidates) {
+        if (projectedUsage() <= target) {
+            break;
+        }
+
+        move(*resource, false);
+        ++mStatistics.evictions;
+    }
+}
+
+void ResidencyManager::promote(vk::DeviceSize target) {
+    std::vector<Resource*> candidates;
+    for (auto& [handle, resource] : mResources) {
+        if (!resource.resident) {
+            candidates.push_back(&resource);
+        }
+    }
+
+    std::ranges::sort(candidates, std::ranges::greater{}, &Resource::lastUsedFrame);
+
+    vk::DeviceSize promoted = 0;
+    for (Resource* resource : candidates) {
+        if (projectedUsage() + resource->size > target || promoted + resource->size > MAX_PROMOTION_PER_FRAME) {
+            break;
+        }
+
+        move(*resource, true);
+        if (!resource->resident) {
+            break;
+        }
+
+        promoted += resource->size;
+        ++mStatistics.promotions;
+    }
+}
+
+void ResidencyManager::submitCopies(uint32_t frameIndex) {
+    if (mPendingCopies.empty()) {
+        return;
+    }
+
+    auto& cmd = mCommandBuffers[frameIndex];
+    cmd.reset();
+    cmd.begin({ .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+
+    // Moves read buffers that earlier frames wrote on the GPU, such as the light grid. The fence wait
+    // before the update only orders the host, the writes still have to be made visible to the copies.
+    vk::MemoryBarrier2 beginBarrier {
+        .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .srcAccessMask = vk::AccessFlagBits2::eShaderWrite | vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .dstAccessMask = vk::AccessFlagBits2::eTransferRead
+    };
+    cmd.pipelineBarrier2({ .memoryBarrierCount = 1, .pMemoryBarriers = &beginBarrier });
+
+    // An upload followed by a move of the same buffer reads what the upload wrote, so copies touching a
+    // buffer written earlier in the batch wait for the writes before them
+    std::vector<vk::Buffer> written;
+    for (const auto& copy : mPendingCopies) {
+        if (std::ranges::find(written, copy.src) != written.end() || std::ranges::find(written, copy.dst) != written.end()) {
+            vk::MemoryBarrier2 copyBarrier {
+                .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+                .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+                .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+                .dstAccessMask = vk::AccessFlagBits2::eTransferRead | vk::AccessFlagBits2::eTransferWrite
+            };
+            cmd.pipelineBarrier2({ .memoryBarrierCount = 1, .pMemoryBarriers = &copyBarrier });
+            written.clear();
+        }
+
+        cmd.copyBuffer(copy.src, copy.dst, vk::BufferCopy { .srcOffset = copy.srcOffset, .dstOffset = copy.dstOffset, .size = copy.size });
+        written.push_back(copy.dst);
+    }
+
+    // Later submissions on this queue read the copied buffers and also write them, such as clearing
+    // and rebinning the light lists, which must not race the copy writes
+    vk::MemoryBarrier2 barrier {
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .dstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite
+    };
+
+    vk::DependencyInfo dependencyInfo {
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &barrier
+    };
+    cmd.pipelineBarrier2(dependencyInfo);
+
+    cmd.end();
+
+    const vk::SubmitInfo submitInfo {
+        .commandBufferCount = 1,
+        .pCommandBuffers = &*cmd
+    };
+    mQueue.submit(submitInfo);
+
+    mPendingCopies.clear();
+}
+
+}
\ No newline at end of file
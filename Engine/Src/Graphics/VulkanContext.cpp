@@ -1,7 +1,10 @@
 #include <Graphics/VulkanContext.h>
 
 #include <algorithm>
-#include <fstream>
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
 #include <stdexcept>
 #include <string>
 
@@ -9,6 +12,9 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include <Core/TaskGraph.h>
+#include <Graphics/VulkanUtils.h>
+
 namespace VE::Gfx {
 
 std::vector<const char*> deviceExtensions = {
@@ -16,21 +22,140 @@ std::vector<const char*> deviceExtensions = {
     vk::KHRSynchronization2ExtensionName
 };
 
+// Read on a worker thread while the instance and device are created
+const std::vector<std::string> shaderPaths = {
+    "Assets/Shader/triangle.spv",
+    "Assets/Shader/mesh.spv",
+    "Assets/Shader/tonemap.spv",
+    "Assets/Shader/composite.spv",
+    "Assets/Shader/clustered_cull.spv",
+    "Assets/Shader/meshlet_cull.spv"
+};
+
+// Device scoring, each type is a tier above the last. Memory in MiB and dedicated queues rank devices
+// within a tier and are clamped below the next one, so no amount of memory lifts a device's type.
+constexpr uint64_t DEVICE_TYPE_TIER = 1ull << 32;
+constexpr uint64_t DISCRETE_GPU_TIER = 3;
+constexpr uint64_t INTEGRATED_GPU_TIER = 2;
+constexpr uint64_t VIRTUAL_GPU_TIER = 1;
+constexpr uint64_t ASYNC_COMPUTE_SCORE = 4'096;
+constexpr uint64_t ASYNC_TRANSFER_SCORE = 1'024;
+
+// Timestamps written per frame in flight
+enum TimestampQuery : uint32_t {
+    SceneBegin,
+    SceneEnd,
+    CompositeBegin,
+    CompositeEnd,
+    PostProcessBegin,
+    PostProcessEnd,
+    TimestampCount
+};
+
+struct TonemapConstants {
+    uint32_t width;
+    uint32_t height;
+    float exposure;
+};
+
+struct CompositeConstants {
+    glm::vec2 uvScale;      // Render extent over target extent
+    glm::vec2 uvMax;        // Center of the last rendered texel, keeps the filter inside the render extent
+};
+
 // -----------------------------------------------------------------------------------------------
 // Utility Functions
 // -----------------------------------------------------------------------------------------------
-bool IsDeviceSuitable(const vk::raii::PhysicalDevice& physicalDevice) {
-    auto deviceProperties = physicalDevice.getProperties();
-    auto deviceFeatures = physicalDevice.getFeatures();
+// Zero for devices that cannot run the engine, otherwise higher is better
+uint64_t ScorePhysicalDevice(const vk::raii::PhysicalDevice& physicalDevice) {
+    const auto deviceProperties = physicalDevice.getProperties();
+    if (deviceProperties.apiVersion < vk::ApiVersion14) {
+        return 0;
+    }
 
-    if (deviceProperties.deviceType != vk::PhysicalDeviceType::eDiscreteGpu) {
+    const auto featureChain = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+    if (!featureChain.get<vk::PhysicalDeviceVulkan12Features>().drawIndirectCount) {
+        return 0;
     }
 
-    if (deviceProperties.apiVersion < vk::ApiVersion14) {
-        return false;
+    const auto extensionProperties = physicalDevice.enumerateDeviceExtensionProperties();
+    for (const char* extension : deviceExtensions) {
+        if (std::ranges::none_of(extensionProperties, [extension](const auto& extensionProperty) {
+            return strcmp(extensionProperty.extensionName, extension) == 0;
+        })) {
+            return 0;
+        }
     }
 
-    return true;
+    const auto queueFamilyProperties = physicalDevice.getQueueFamilyProperties();
+    if (std::ranges::none_of(queueFamilyProperties, [](const auto& qfp) { return static_cast<bool>(qfp.queueFlags & vk::QueueFlagBits::eGraphics); })) {
+        return 0;
+    }
+
+    uint64_t tier = 0;
+    switch (deviceProperties.deviceType) {
+        case vk::PhysicalDeviceType::eDiscreteGpu: tier = DISCRETE_GPU_TIER; break;
+        case vk::PhysicalDeviceType::eIntegratedGpu: tier = INTEGRATED_GPU_TIER; break;
+        case vk::PhysicalDeviceType::eVirtualGpu: tier = VIRTUAL_GPU_TIER; break;
+        default: break;
+    }
+
+    uint64_t score = 0;
+
+    // Largest device-local heap
+    const auto memoryProperties = physicalDevice.getMemoryProperties();
+    vk::DeviceSize deviceLocalMemory = 0;
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i) {
+        if (memoryProperties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal) {
+            deviceLocalMemory = std::max(deviceLocalMemory, memoryProperties.memoryHeaps[i].size);
+        }
+    }
+    score += deviceLocalMemory / (1024 * 1024);
+
+    // Dedicated queue families let post-processing and uploads overlap rendering
+    for (const auto& qfp : queueFamilyProperties) {
+        if ((qfp.queueFlags & vk::QueueFlagBits::eCompute) && !(qfp.queueFlags & vk::QueueFlagBits::eGraphics)) {
+            score += ASYNC_COMPUTE_SCORE;
+            break;
+        }
+    }
+    for (const auto& qfp : queueFamilyProperties) {
+        if ((qfp.queueFlags & vk::QueueFlagBits::eTransfer) && !(qfp.queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute))) {
+            score += ASYNC_TRANSFER_SCORE;
+            break;
+        }
+    }
+
+    return 1 + tier * DEVICE_TYPE_TIER + std::min(score, DEVICE_TYPE_TIER - 2);
+}
+
+// Per-user cache directory, it holds one pipeline cache per device since a driver only accepts data it wrote itself
+std::filesystem::path PipelineCacheDirectory() {
+    std::filesystem::path directory;
+#ifdef _WIN32
+    if (const char* localAppData = std::getenv("LOCALAPPDATA")) {
+        directory = localAppData;
+    }
+#else
+    if (const char* xdgCache = std::getenv("XDG_CACHE_HOME"); xdgCache && *xdgCache) {
+        directory = xdgCache;
+    }
+    else if (const char* home = std::getenv("HOME")) {
+        directory = std::filesystem::path(home) / ".cache";
+    }
+#endif
+
+    // Without a home the working directory is the only place left
+    if (directory.empty()) {
+        directory = std::filesystem::current_path();
+    }
+
+    return directory / "VulkanEngine";
+}
+
+// Timestamps only count in their valid bits and wrap around above them
+uint64_t TimestampMask(uint32_t validBits) {
+    return validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
 }
 
 uint32_t FindQueueFamilies(const vk::raii::PhysicalDevice& physicalDevice, vk::QueueFlags queueFlags) {
@@ -47,6 +172,20 @@ uint32_t FindQueueFamilies(const vk::raii::PhysicalDevice& physicalDevice, vk::Q
 
 }
 
+uint32_t FindComputeQueueFamily(const vk::raii::PhysicalDevice& physicalDevice, uint32_t graphicsQueueFamilyIndex) {
+    auto queueFamilyProperties = physicalDevice.getQueueFamilyProperties();
+
+    // A compute-only family maps to the hardware's async compute queues
+    for (uint32_t i = 0; i < queueFamilyProperties.size(); ++i) {
+        const auto flags = queueFamilyProperties[i].queueFlags;
+        if ((flags & vk::QueueFlagBits::eCompute) && !(flags & vk::QueueFlagBits::eGraphics)) {
+            return i;
+        }
+    }
+
+    return graphicsQueueFamilyIndex;
+}
+
 vk::SurfaceFormatKHR ChooseSurfaceFormat(const std::vector<vk::SurfaceFormatKHR>& availableFormats) {
     for (const auto& availableFormat : availableFormats) {
         if (availableFormat.format == vk::Format::eB8G8R8A8Srgb && availableFormat.colorSpace == vk::ColorSpaceKHR::eSrgbNonlinear) {
@@ -81,25 +220,12 @@ vk::Extent2D ChooseSwapExtent(const vk::SurfaceCapabilitiesKHR& capabilities, vo
     };
 }
 
-std::vector<char> ReadFile(const std::string& filename) {
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("failed to open file!");
-    }
-
-    std::vector<char> buffer(file.tellg());
-    file.seekg(0, std::ios::beg);
-    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-    file.close();
-
-    return buffer;
-}
-
 void TransitionImageLayout(
     vk::raii::CommandBuffer& cmd, vk::Image image,
     vk::ImageLayout oldLayout, vk::ImageLayout newLayout,
     vk::AccessFlags2 srcAccessMask, vk::AccessFlags2 dstAccessMask,
-    vk::PipelineStageFlags2 srcStageMask, vk::PipelineStageFlags2 dstStageMask
+    vk::PipelineStageFlags2 srcStageMask, vk::PipelineStageFlags2 dstStageMask,
+    vk::ImageAspectFlags aspectMask = vk::ImageAspectFlagBits::eColor
 ) {
     vk::ImageMemoryBarrier2 barrier = {
         .srcStageMask = srcStageMask,
@@ -112,7 +238,7 @@ void TransitionImageLayout(
         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
         .image = image,
         .subresourceRange = {
-            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .aspectMask = aspectMask,
             .baseMipLevel = 0,
             .levelCount = 1,
             .baseArrayLayer = 0,
@@ -133,49 +259,125 @@ void TransitionImageLayout(
 // VulkanContext
 // -----------------------------------------------------------------------------------------------
 VulkanContext::VulkanContext(void* window) : mWindow(static_cast<GLFWwindow*>(window)) {
-    createInstance();
-    selectPhysicalDevice();
-    createLogicalDevice();
-    createSurface();
-    createSwapchain();
-    allocateCommandBuffers();
-    createSyncObjects();
-    createGraphicsPipeline();
+    Core::TaskGraph startup;
+
+    // File reads do not need a device and overlap instance creation, the cache matching the device is picked later
+    const auto shaders = startup.Add("LoadShaders", [this] { mPipelineLibrary.LoadShaders(shaderPaths); });
+    const auto cacheData = startup.Add("LoadPipelineCache", [this] { mPipelineLibrary.LoadCacheData(PipelineCacheDirectory()); });
+    const auto instance = startup.Add("CreateInstance", [this] { createInstance(); });
+
+    // Devices are enumerated and scored while the surface is created, presentation support is checked last
+    const auto surface = startup.Add("CreateSurface", [this] { createSurface(); }, { instance });
+    const auto devices = startup.Add("EnumerateDevices", [this] { enumeratePhysicalDevices(); }, { instance });
+    const auto device = startup.Add("CreateDevice", [this] { selectPhysicalDevice(); createLogicalDevice(); }, { devices, surface });
+    const auto pipelineCache = startup.Add("CreatePipelineCache", [this] { mPipelineLibrary.CreatePipelineCache(mDevice, mPhysicalDevice); }, { device, cacheData });
+
+    // Window size queries are restricted to the main thread by GLFW
+    const auto swapchain = startup.Add("CreateSwapchain", [this] { createSwapchain(); }, { device, surface }, true);
+    startup.Add("CreateFrameResources", [this] { allocateCommandBuffers(); createSyncObjects(); createTimestampQueries(); }, { swapchain });
+
+    // Pipelines compile in parallel, only the lighting and meshlet chain allocates through the residency manager
+    const auto lighting = startup.Add("CreateLighting", [this] { createLighting(); }, { shaders, pipelineCache });
+    startup.Add("CreateGraphicsPipeline", [this] { createGraphicsPipeline(); }, { lighting });
+    startup.Add("CreateMeshletRenderer", [this] { createMeshletRenderer(); }, { lighting });
+    const auto postProcess = startup.Add("CreatePostProcessPasses", [this] { createPostProcessPasses(); }, { shaders, pipelineCache });
+    const auto composite = startup.Add("CreateCompositePass", [this] { createCompositePass(); }, { swapchain, shaders, pipelineCache });
+    startup.Add("CreateRenderTargets", [this] { createRenderTargets(); }, { swapchain, postProcess, composite });
+
+    startup.Run();
+    mStartupTimings = startup.GetTimings();
 }
 
 VulkanContext::~VulkanContext() {
     mDevice.waitIdle();
+
+    // The next run starts with every pipeline compiled by this one
+    mPipelineLibrary.SaveCacheData(mPipelineCachePath);
 }
 
 void VulkanContext::Render() {
     auto fenceResult = mDevice.waitForFences(*mDrawFences[mFrameIndex], vk::True, UINT64_MAX);
-    auto [result, imageIndex] = mSwapchain.acquireNextImage(UINT64_MAX, *mPresentCompleteSemaphores[mFrameIndex]);
-    
-    if (result == vk::Result::eErrorOutOfDateKHR) {
+
+    // The copy recorded the last time this frame slot was used has completed by now
+    mFrameCapture->Collect(mFrameIndex);
+
+    readFrameTimings(mFrameIndex);
+
+    // Budget queries and evictions, copies are submitted ahead of this frame's work
+    mResidencyManager->Update(mFrameIndex);
+    mRenderExtents[mFrameIndex] = mDynamicResolution.GetRenderExtent(mSwapExtent);
+    mLighting->Update(mFrameIndex, mCamera, mRenderExtents[mFrameIndex]);
+    mMeshletRenderer->Update(mFrameIndex, mCamera, mRenderExtents[mFrameIndex]);
+
+    // Geometry
+    mSceneCommandBuffers[mFrameIndex].reset();
+    recordSceneCommandBuffer(mFrameIndex);
+
+    const vk::SubmitInfo submitInfo {
+        .commandBufferCount = 1,
+        .pCommandBuffers = &*mSceneCommandBuffers[mFrameIndex],
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &*mSceneFinishedSemaphores[mFrameIndex]
+    };
+    mGraphicsQueue.submit(submitInfo);
+
+    // Post-processing on the compute queue
+    mTonemapPass->Submit(
+        mFrameIndex, *mSceneFinishedSemaphores[mFrameIndex], vk::PipelineStageFlagBits::eComputeShader,
+        [this](vk::raii::CommandBuffer& cmd) { recordPostProcess(cmd, mFrameIndex); }
+    );
+
+    // Present the previous frame, its post-processing ran alongside the geometry submitted above
+    const bool swapchainValid = !mPendingPresent || presentPendingFrame();
+
+    mPendingPresent = true;
+    mPendingFrameIndex = mFrameIndex;
+    mFrameIndex = (mFrameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+    ++mFrameCount;
+
+    if (!swapchainValid) {
         recreateSwapchain();
-        return;
+    }
+}
+
+bool VulkanContext::presentPendingFrame() {
+    const uint32_t frameIndex = mPendingFrameIndex;
+    mPendingPresent = false;
+
+    auto [result, imageIndex] = mSwapchain.acquireNextImage(UINT64_MAX, *mPresentCompleteSemaphores[frameIndex]);
+
+    if (result == vk::Result::eErrorOutOfDateKHR) {
+        discardFrame(frameIndex);
+        return false;
     }
     if (result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR) {
         throw std::runtime_error("failed to acquire swap chain image!");
     }
 
-    mDevice.resetFences(*mDrawFences[mFrameIndex]);
+    mDevice.resetFences(*mDrawFences[frameIndex]);
 
-    mCommandBuffers[mFrameIndex].reset();
-    recordCommandBuffer(imageIndex);
+    mCommandBuffers[frameIndex].reset();
+    recordCompositeCommandBuffer(frameIndex, imageIndex);
 
     // Submit the command buffer
-    vk::PipelineStageFlags waitDestinationStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+    const std::array<vk::Semaphore, 2> waitSemaphores = {
+        *mPresentCompleteSemaphores[frameIndex],
+        mTonemapPass->GetFinishedSemaphore(frameIndex)
+    };
+    // Frame capture may also copy the post-processed image in the transfer stage
+    const std::array<vk::PipelineStageFlags, 2> waitDestinationStageMasks = mBlitComposite
+        ? std::array { vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTransfer), vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTransfer) }
+        : std::array { vk::PipelineStageFlags(vk::PipelineStageFlagBits::eColorAttachmentOutput), vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eTransfer };
     const vk::SubmitInfo submitInfo {
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &*mPresentCompleteSemaphores[mFrameIndex],
-        .pWaitDstStageMask = &waitDestinationStageMask,
+        .waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+        .pWaitSemaphores = waitSemaphores.data(),
+        .pWaitDstStageMask = waitDestinationStageMasks.data(),
         .commandBufferCount = 1,
-        .pCommandBuffers = &*mCommandBuffers[mFrameIndex],
+        .pCommandBuffers = &*mCommandBuffers[frameIndex],
         .signalSemaphoreCount = 1,
         .pSignalSemaphores = &*mRenderFinishedSemaphores[imageIndex]
     };
-    mGraphicsQueue.submit(submitInfo, *mDrawFences[mFrameIndex]);
+    mGraphicsQueue.submit(submitInfo, *mDrawFences[frameIndex]);
 
     // Presentation
     try {
@@ -189,8 +391,7 @@ void VulkanContext::Render() {
         result = mGraphicsQueue.presentKHR(presentInfo);
 
         if (result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR) {
-            recreateSwapchain();
-            return;
+            return false;
         }
         else if (result != vk::Result::eSuccess) {
             throw std::runtime_error("failed to present swap chain image!");
@@ -198,15 +399,28 @@ void VulkanContext::Render() {
     }
     catch (const vk::SystemError& e) {
         if (e.code().value() == static_cast<int>(vk::Result::eErrorOutOfDateKHR)) {
-            recreateSwapchain();
-            return;
+            return false;
         }
         else {
             throw;
         }
     }
 
-    mFrameIndex = (mFrameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+    return true;
+}
+
+void VulkanContext::discardFrame(uint32_t frameIndex) {
+    // Wait on the post-processing semaphore anyway so it is unsignaled before the slot is reused
+    vk::Semaphore waitSemaphore = mTonemapPass->GetFinishedSemaphore(frameIndex);
+    vk::PipelineStageFlags waitDestinationStageMask(vk::PipelineStageFlagBits::eAllCommands);
+    const vk::SubmitInfo submitInfo {
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = &waitSemaphore,
+        .pWaitDstStageMask = &waitDestinationStageMask
+    };
+
+    mDevice.resetFences(*mDrawFences[frameIndex]);
+    mGraphicsQueue.submit(submitInfo, *mDrawFences[frameIndex]);
 }
 
 void VulkanContext::createInstance() {
@@ -257,61 +471,97 @@ void VulkanContext::createInstance() {
     mInstance = vk::raii::Instance(mContext, createInfo);
 }
 
-void VulkanContext::selectPhysicalDevice() {
+void VulkanContext::enumeratePhysicalDevices() {
     auto devices = mInstance.enumeratePhysicalDevices();
     if (devices.empty()) {
         throw std::runtime_error("failed to find GPUs with Vulkan support!");
     }
 
-    const auto devIter = std::ranges::find_if(devices,
-        [&](const auto& device) {
-            bool isSuitable = IsDeviceSuitable(device);
-            if (isSuitable) {
-                mPhysicalDevice = device;
-            }
-            return isSuitable;
+    mDeviceCandidates.clear();
+    for (const auto& device : devices) {
+        const uint64_t score = ScorePhysicalDevice(device);
+        if (score > 0) {
+            mDeviceCandidates.push_back({ .device = device, .score = score });
         }
-    );
+    }
+
+    std::ranges::stable_sort(mDeviceCandidates, std::ranges::greater {}, &DeviceCandidate::score);
+}
 
-    if (devIter == devices.end()) {
+void VulkanContext::selectPhysicalDevice() {
+    // Rendering and presentation share the graphics queue
+    const auto candidate = std::ranges::find_if(mDeviceCandidates, [this](const DeviceCandidate& candidate) {
+        const uint32_t graphicsQueueFamily = FindQueueFamilies(candidate.device, vk::QueueFlagBits::eGraphics);
+        return static_cast<bool>(candidate.device.getSurfaceSupportKHR(graphicsQueueFamily, *mSurface));
+    });
+
+    if (candidate == mDeviceCandidates.end()) {
         throw std::runtime_error("failed to find a suitable GPU!");
     }
+
+    mPhysicalDevice = candidate->device;
+    const auto properties = mPhysicalDevice.getProperties();
+    mPipelineCachePath = PipelineCacheDirectory() / std::format("pipeline_cache_{:04x}_{:04x}.bin", properties.vendorID, properties.deviceID);
+    mDeviceCandidates.clear();
 }
 
 void VulkanContext::createLogicalDevice() {
-    uint32_t graphicsQueueFamilyIndex = FindQueueFamilies(mPhysicalDevice, vk::QueueFlagBits::eGraphics);
-    float queuePriority = 1.0f;
-
-    vk::DeviceQueueCreateInfo deviceQueueCreateInfo {
-        .queueFamilyIndex = graphicsQueueFamilyIndex,
-        .queueCount = 1,
-        .pQueuePriorities = &queuePriority
-    };
+    mGraphicsQueueFamily = FindQueueFamilies(mPhysicalDevice, vk::QueueFlagBits::eGraphics);
+    mComputeQueueFamily = FindComputeQueueFamily(mPhysicalDevice, mGraphicsQueueFamily);
+    const std::array<float, 2> queuePriorities = { 1.0f, 1.0f };
+
+    std::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos;
+    uint32_t computeQueueIndex = 0;
+    if (mComputeQueueFamily != mGraphicsQueueFamily) {
+        deviceQueueCreateInfos.push_back({ .queueFamilyIndex = mGraphicsQueueFamily, .queueCount = 1, .pQueuePriorities = queuePriorities.data() });
+        deviceQueueCreateInfos.push_back({ .queueFamilyIndex = mComputeQueueFamily, .queueCount = 1, .pQueuePriorities = queuePriorities.data() });
+    }
+    else {
+        // No compute-only family, a second queue of the graphics family can still overlap work
+        auto queueFamilyProperties = mPhysicalDevice.getQueueFamilyProperties();
+        computeQueueIndex = queueFamilyProperties[mGraphicsQueueFamily].queueCount > 1 ? 1 : 0;
+        deviceQueueCreateInfos.push_back({ .queueFamilyIndex = mGraphicsQueueFamily, .queueCount = computeQueueIndex + 1, .pQueuePriorities = queuePriorities.data() });
+    }
 
     // Create a chain of feature structures
-    vk::StructureChain<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan13Features> featureChain = {
+    vk::StructureChain<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features, vk::PhysicalDeviceVulkan13Features> featureChain = {
         {},
+        { .drawIndirectCount = true },                              // Enable count-driven indirect draws from Vulkan 1.2
         { .synchronization2 = true, .dynamicRendering = true },   // Enable synchronization2 and dynamic rendering from Vulkan 1.3
     };
 
+    // Optional extensions
+    std::vector<const char*> enabledExtensions = deviceExtensions;
+    auto extensionProperties = mPhysicalDevice.enumerateDeviceExtensionProperties();
+    mMemoryBudgetSupported = std::ranges::any_of(extensionProperties, [](const auto& extensionProperty) {
+        return strcmp(extensionProperty.extensionName, vk::EXTMemoryBudgetExtensionName) == 0;
+    });
+    if (mMemoryBudgetSupported) {
+        enabledExtensions.push_back(vk::EXTMemoryBudgetExtensionName);
+    }
+
     vk::DeviceCreateInfo deviceCreateInfo {
         .pNext = &featureChain.get<vk::PhysicalDeviceFeatures2>(),
-        .queueCreateInfoCount = 1,
-        .pQueueCreateInfos = &deviceQueueCreateInfo,
-        .enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
-        .ppEnabledExtensionNames = deviceExtensions.data()
+        .queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCreateInfos.size()),
+        .pQueueCreateInfos = deviceQueueCreateInfos.data(),
+        .enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size()),
+        .ppEnabledExtensionNames = enabledExtensions.data()
     };
 
     mDevice = vk::raii::Device(mPhysicalDevice, deviceCreateInfo);
-    mGraphicsQueue = vk::raii::Queue(mDevice, graphicsQueueFamilyIndex, 0);
+    mGraphicsQueue = vk::raii::Queue(mDevice, mGraphicsQueueFamily, 0);
+    mComputeQueue = vk::raii::Queue(mDevice, mComputeQueueFamily, computeQueueIndex);
 
     // Create command pool
     vk::CommandPoolCreateInfo poolInfo {
         .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-        .queueFamilyIndex = graphicsQueueFamilyIndex
+        .queueFamilyIndex = mGraphicsQueueFamily
     };
 
     mCommandPool = vk::raii::CommandPool(mDevice, poolInfo);
+
+    mFrameCapture = std::make_unique<FrameCapture>(mDevice, mPhysicalDevice);
+    mResidencyManager = std::make_unique<ResidencyManager>(mDevice, mPhysicalDevice, mGraphicsQueue, mGraphicsQueueFamily, mMemoryBudgetSupported);
 }
 
 void VulkanContext::createSurface() {
@@ -328,6 +578,27 @@ void VulkanContext::createSwapchain() {
     mSwapFormat = ChooseSurfaceFormat(mPhysicalDevice.getSurfaceFormatsKHR(*mSurface));
     mSwapExtent = ChooseSwapExtent(surfaceCapabilities, mWindow);
 
+    // The post-processed frame is blitted into the swapchain image when the surface and both formats
+    // support it, otherwise it is drawn by a fullscreen pass
+    constexpr vk::FormatFeatureFlags blitSourceFeatures = vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+    const auto sourceFeatures = mPhysicalDevice.getFormatProperties(POST_PROCESS_FORMAT).optimalTilingFeatures;
+    const auto swapFeatures = mPhysicalDevice.getFormatProperties(mSwapFormat.format).optimalTilingFeatures;
+    mBlitComposite = (surfaceCapabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferDst)
+        && (sourceFeatures & blitSourceFeatures) == blitSourceFeatures
+        && (swapFeatures & vk::FormatFeatureFlagBits::eBlitDst);
+
+    // Frame capture copies out of the swapchain images when the surface and format allow it, otherwise
+    // out of the post-processed image
+    mSwapchainReadback = (surfaceCapabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferSrc)
+        && FrameCapture::IsFormatSupported(mSwapFormat.format);
+    vk::ImageUsageFlags imageUsage = vk::ImageUsageFlagBits::eColorAttachment;
+    if (mBlitComposite) {
+        imageUsage |= vk::ImageUsageFlagBits::eTransferDst;
+    }
+    if (mSwapchainReadback) {
+        imageUsage |= vk::ImageUsageFlagBits::eTransferSrc;
+    }
+
     uint32_t imageCount = surfaceCapabilities.minImageCount + 1;
     if (surfaceCapabilities.maxImageCount > 0 && surfaceCapabilities.maxImageCount < imageCount) {
         imageCount = surfaceCapabilities.maxImageCount;
@@ -341,7 +612,7 @@ void VulkanContext::createSwapchain() {
         .imageColorSpace = mSwapFormat.colorSpace,
         .imageExtent = mSwapExtent,
         .imageArrayLayers = 1,
-        .imageUsage = vk::ImageUsageFlagBits::eColorAttachment,
+        .imageUsage = imageUsage,
         .imageSharingMode = vk::SharingMode::eExclusive,
         .preTransform = surfaceCapabilities.currentTransform,
         .compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque,
@@ -365,9 +636,19 @@ void VulkanContext::createSwapchain() {
         imageViewCreateInfo.image = image;
         mSwapchainImageViews.emplace_back(mDevice, imageViewCreateInfo);
     }
+
+    if (mSwapchainReadback) {
+        mFrameCapture->Resize(mSwapExtent, mSwapFormat.format);
+    }
+    else {
+        // Post-processing writes linear values, which an sRGB swapchain encodes on composite
+        const bool srgbSwapchain = mSwapFormat.format == vk::Format::eB8G8R8A8Srgb || mSwapFormat.format == vk::Format::eR8G8B8A8Srgb;
+        mFrameCapture->Resize(mSwapExtent, POST_PROCESS_FORMAT, srgbSwapchain);
+    }
 }
 
 void VulkanContext::allocateCommandBuffers() {
+    mSceneCommandBuffers.clear();
     mCommandBuffers.clear();
 
     vk::CommandBufferAllocateInfo allocInfo {
@@ -376,12 +657,14 @@ void VulkanContext::allocateCommandBuffers() {
         .commandBufferCount = MAX_FRAMES_IN_FLIGHT
     };
 
+    mSceneCommandBuffers = vk::raii::CommandBuffers(mDevice, allocInfo);
     mCommandBuffers = vk::raii::CommandBuffers(mDevice, allocInfo);
 }
 
 void VulkanContext::createSyncObjects() {
     mPresentCompleteSemaphores.clear();
     mRenderFinishedSemaphores.clear();
+    mSceneFinishedSemaphores.clear();
     mDrawFences.clear();
 
     for (size_t i = 0; i < mSwapchainImages.size(); ++i) {
@@ -389,12 +672,13 @@ void VulkanContext::createSyncObjects() {
     }
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
         mPresentCompleteSemaphores.emplace_back(mDevice, vk::SemaphoreCreateInfo());
+        mSceneFinishedSemaphores.emplace_back(mDevice, vk::SemaphoreCreateInfo());
         mDrawFences.emplace_back(mDevice, vk::FenceCreateInfo{ .flags = vk::FenceCreateFlagBits::eSignaled });
     }
 }
 
 void VulkanContext::createGraphicsPipeline() {
-    vk::raii::ShaderModule shaderModule = createShaderModule(ReadFile("Assets/Shader/triangle.spv"));
+    vk::raii::ShaderModule shaderModule = createShaderModule(mPipelineLibrary.GetShader("Assets/Shader/triangle.spv"));
 
     vk::PipelineShaderStageCreateInfo vertShaderStageInfo {
         .stage = vk::ShaderStageFlagBits::eVertex,
@@ -452,7 +736,9 @@ void VulkanContext::createGraphicsPipeline() {
 
     // Depth and stencil testing
     vk::PipelineDepthStencilStateCreateInfo depthStencil {
-
+        .depthTestEnable = vk::True,
+        .depthWriteEnable = vk::True,
+        .depthCompareOp = vk::CompareOp::eLess
     };
 
     // Color blending
@@ -469,16 +755,20 @@ void VulkanContext::createGraphicsPipeline() {
     };
 
     // Pipeline layout
+    const vk::DescriptorSetLayout lightingSetLayout = mLighting->GetDescriptorSetLayout();
     vk::PipelineLayoutCreateInfo pipelineLayoutInfo {
-        .setLayoutCount = 0,
+        .setLayoutCount = 1,
+        .pSetLayouts = &lightingSetLayout,
         .pushConstantRangeCount = 0
     };
     mPipelineLayout = vk::raii::PipelineLayout(mDevice, pipelineLayoutInfo);
 
     // Dynamic rendering
+    constexpr vk::Format colorAttachmentFormat = SCENE_COLOR_FORMAT;
     vk::PipelineRenderingCreateInfo pipelineRenderingCreateInfo {
         .colorAttachmentCount = 1,
-        .pColorAttachmentFormats = &mSwapFormat.format
+        .pColorAttachmentFormats = &colorAttachmentFormat,
+        .depthAttachmentFormat = DEPTH_FORMAT
     };
 
     vk::GraphicsPipelineCreateInfo pipelineInfo {
@@ -490,13 +780,295 @@ void VulkanContext::createGraphicsPipeline() {
         .pViewportState = &viewportState,
         .pRasterizationState = &rasterizer,
         .pMultisampleState = &multisampling,
+        .pDepthStencilState = &depthStencil,
         .pColorBlendState = &colorBlending,
         .pDynamicState = &dynamicState,
         .layout = mPipelineLayout,
         .renderPass = nullptr
     };
 
-    mGraphicsPipeline = vk::raii::Pipeline(mDevice, nullptr, pipelineInfo);
+    mGraphicsPipeline = vk::raii::Pipeline(mDevice, mPipelineLibrary.GetPipelineCache(), pipelineInfo);
+}
+
+void VulkanContext::createRenderTargets() {
+    // Targets are shared with the compute queue without ownership transfers
+    std::vector<uint32_t> queueFamilies = { mGraphicsQueueFamily };
+    if (mComputeQueueFamily != mGraphicsQueueFamily) {
+        queueFamilies.push_back(mComputeQueueFamily);
+    }
+
+    mSceneColorTargets.clear();
+    mDepthTargets.clear();
+    mPostProcessTargets.clear();
+    mSceneColorTargets.resize(MAX_FRAMES_IN_FLIGHT);
+    mDepthTargets.resize(MAX_FRAMES_IN_FLIGHT);
+    mPostProcessTargets.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        auto& scene = mSceneColorTargets[i];
+        CreateImage(
+            mDevice, mPhysicalDevice, mSwapExtent.width, mSwapExtent.height, SCENE_COLOR_FORMAT,
+            vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eStorage,
+            vk::MemoryPropertyFlagBits::eDeviceLocal, queueFamilies, scene.image, scene.memory
+        );
+        scene.view = CreateImageView(mDevice, scene.image, SCENE_COLOR_FORMAT);
+
+        // Depth never leaves the graphics queue
+        auto& depth = mDepthTargets[i];
+        CreateImage(
+            mDevice, mPhysicalDevice, mSwapExtent.width, mSwapExtent.height, DEPTH_FORMAT,
+            vk::ImageUsageFlagBits::eDepthStencilAttachment,
+            vk::MemoryPropertyFlagBits::eDeviceLocal, { mGraphicsQueueFamily }, depth.image, depth.memory
+        );
+        depth.view = CreateImageView(mDevice, depth.image, DEPTH_FORMAT, vk::ImageAspectFlagBits::eDepth);
+
+        auto& output = mPostProcessTargets[i];
+        CreateImage(
+            mDevice, mPhysicalDevice, mSwapExtent.width, mSwapExtent.height, POST_PROCESS_FORMAT,
+            vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled,
+            vk::MemoryPropertyFlagBits::eDeviceLocal, queueFamilies, output.image, output.memory
+        );
+        output.view = CreateImageView(mDevice, output.image, POST_PROCESS_FORMAT);
+
+        mTonemapPass->WriteStorageImage(i, 0, scene.view);
+        mTonemapPass->WriteStorageImage(i, 1, output.view);
+
+        if (!mCompositeDescriptorSets.empty()) {
+            vk::DescriptorImageInfo imageInfo {
+                .sampler = mCompositeSampler,
+                .imageView = output.view,
+                .imageLayout = vk::ImageLayout::eGeneral
+            };
+
+            vk::WriteDescriptorSet write {
+                .dstSet = mCompositeDescriptorSets[i],
+                .dstBinding = 0,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+                .pImageInfo = &imageInfo
+            };
+            mDevice.updateDescriptorSets(write, {});
+        }
+    }
+}
+
+void VulkanContext::createTimestampQueries() {
+    auto queueFamilyProperties = mPhysicalDevice.getQueueFamilyProperties();
+    if (queueFamilyProperties[mGraphicsQueueFamily].timestampValidBits == 0) {
+        // Without timings there is nothing to drive the resolution
+        mDynamicResolution.Configure({ .enabled = false });
+        return;
+    }
+
+    mTimestampPeriod = mPhysicalDevice.getProperties().limits.timestampPeriod;
+    mComputeTimestamps = queueFamilyProperties[mComputeQueueFamily].timestampValidBits > 0;
+    mGraphicsTimestampMask = TimestampMask(queueFamilyProperties[mGraphicsQueueFamily].timestampValidBits);
+    mComputeTimestampMask = TimestampMask(queueFamilyProperties[mComputeQueueFamily].timestampValidBits);
+
+    vk::QueryPoolCreateInfo queryPoolInfo {
+        .queryType = vk::QueryType::eTimestamp,
+        .queryCount = TimestampCount * MAX_FRAMES_IN_FLIGHT
+    };
+    mTimestampQueryPool = vk::raii::QueryPool(mDevice, queryPoolInfo);
+}
+
+void VulkanContext::readFrameTimings(uint32_t frameIndex) {
+    // Queries are first reset by the frame's own command buffer
+    if (!*mTimestampQueryPool || mFrameCount < MAX_FRAMES_IN_FLIGHT) {
+        return;
+    }
+
+    // The frame's fence has signaled, so this never waits. Frames that were never composited
+    // (first frames in flight, discarded frames) report eNotReady and are skipped.
+    const uint32_t queryCount = mComputeTimestamps ? TimestampCount : PostProcessBegin;
+    auto [result, timestamps] = mTimestampQueryPool.getResults<uint64_t>(
+        frameIndex * TimestampCount, queryCount, queryCount * sizeof(uint64_t), sizeof(uint64_t), vk::QueryResultFlagBits::e64
+    );
+    if (result != vk::Result::eSuccess) {
+        return;
+    }
+
+    uint64_t ticks = ((timestamps[SceneEnd] - timestamps[SceneBegin]) & mGraphicsTimestampMask)
+        + ((timestamps[CompositeEnd] - timestamps[CompositeBegin]) & mGraphicsTimestampMask);
+    if (mComputeTimestamps) {
+        const uint64_t postProcessTicks = (timestamps[PostProcessEnd] - timestamps[PostProcessBegin]) & mComputeTimestampMask;
+
+        // On its own queue post-processing runs alongside the next frame's geometry and only limits
+        // the frame rate when it takes longer than the graphics work. On a shared queue it serializes.
+        ticks = *mComputeQueue != *mGraphicsQueue ? std::max(ticks, postProcessTicks) : ticks + postProcessTicks;
+    }
+
+    mGpuFrameTimeMs = static_cast<float>(static_cast<double>(ticks) * mTimestampPeriod * 1e-6);
+    mDynamicResolution.Update(mGpuFrameTimeMs);
+}
+
+void VulkanContext::createLighting() {
+    mLighting = std::make_unique<ClusteredLighting>(mDevice, mPhysicalDevice, mGraphicsQueue, mGraphicsQueueFamily, mPipelineLibrary, *mResidencyManager);
+}
+
+void VulkanContext::createMeshletRenderer() {
+    mMeshletRenderer = std::make_unique<MeshletRenderer>(
+        mDevice, mPhysicalDevice, mGraphicsQueue, mGraphicsQueueFamily, mPipelineLibrary,
+        *mResidencyManager, mLighting->GetDescriptorSetLayout(), SCENE_COLOR_FORMAT, DEPTH_FORMAT
+    );
+}
+
+void VulkanContext::createPostProcessPasses() {
+    ComputePassDesc tonemapDesc {
+        .code = mPipelineLibrary.GetShader("Assets/Shader/tonemap.spv"),
+        .entryPoint = "compMain",
+        .bindings = {
+            { .binding = 0, .descriptorType = vk::DescriptorType::eStorageImage, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute },
+            { .binding = 1, .descriptorType = vk::DescriptorType::eStorageImage, .descriptorCount = 1, .stageFlags = vk::ShaderStageFlagBits::eCompute }
+        },
+        .pushConstantSize = sizeof(TonemapConstants),
+        .pipelineCache = &mPipelineLibrary.GetPipelineCache()
+    };
+
+    mTonemapPass = std::make_unique<ComputePass>(mDevice, mComputeQueue, mComputeQueueFamily, tonemapDesc);
+}
+
+void VulkanContext::createCompositePass() {
+    if (mBlitComposite || (*mCompositePipeline && mCompositeFormat == mSwapFormat.format)) {
+        return;
+    }
+
+    if (!*mCompositeSetLayout) {
+        vk::SamplerCreateInfo samplerInfo {
+            .magFilter = vk::Filter::eLinear,
+            .minFilter = vk::Filter::eLinear,
+            .mipmapMode = vk::SamplerMipmapMode::eNearest,
+            .addressModeU = vk::SamplerAddressMode::eClampToEdge,
+            .addressModeV = vk::SamplerAddressMode::eClampToEdge,
+            .addressModeW = vk::SamplerAddressMode::eClampToEdge,
+            .maxLod = 0.0f
+        };
+        mCompositeSampler = vk::raii::Sampler(mDevice, samplerInfo);
+
+        vk::DescriptorSetLayoutBinding binding {
+            .binding = 0,
+            .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eFragment
+        };
+
+        vk::DescriptorSetLayoutCreateInfo layoutInfo {
+            .bindingCount = 1,
+            .pBindings = &binding
+        };
+        mCompositeSetLayout = vk::raii::DescriptorSetLayout(mDevice, layoutInfo);
+
+        vk::DescriptorPoolSize poolSize {
+            .type = vk::DescriptorType::eCombinedImageSampler,
+            .descriptorCount = MAX_FRAMES_IN_FLIGHT
+        };
+
+        vk::DescriptorPoolCreateInfo poolInfo {
+            .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+            .maxSets = MAX_FRAMES_IN_FLIGHT,
+            .poolSizeCount = 1,
+            .pPoolSizes = &poolSize
+        };
+        mCompositeDescriptorPool = vk::raii::DescriptorPool(mDevice, poolInfo);
+
+        std::vector<vk::DescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, *mCompositeSetLayout);
+        vk::DescriptorSetAllocateInfo allocInfo {
+            .descriptorPool = mCompositeDescriptorPool,
+            .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
+            .pSetLayouts = layouts.data()
+        };
+        mCompositeDescriptorSets = mDevice.allocateDescriptorSets(allocInfo);
+
+        vk::PushConstantRange pushConstantRange {
+            .stageFlags = vk::ShaderStageFlagBits::eFragment,
+            .offset = 0,
+            .size = sizeof(CompositeConstants)
+        };
+
+        vk::PipelineLayoutCreateInfo pipelineLayoutInfo {
+            .setLayoutCount = 1,
+            .pSetLayouts = &*mCompositeSetLayout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &pushConstantRange
+        };
+        mCompositePipelineLayout = vk::raii::PipelineLayout(mDevice, pipelineLayoutInfo);
+    }
+
+    vk::raii::ShaderModule shaderModule = createShaderModule(mPipelineLibrary.GetShader("Assets/Shader/composite.spv"));
+
+    vk::PipelineShaderStageCreateInfo shaderStages[] = {
+        { .stage = vk::ShaderStageFlagBits::eVertex, .module = shaderModule, .pName = "vertMain" },
+        { .stage = vk::ShaderStageFlagBits::eFragment, .module = shaderModule, .pName = "fragMain" }
+    };
+
+    std::vector dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
+    vk::PipelineDynamicStateCreateInfo dynamicState {
+        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+        .pDynamicStates = dynamicStates.data()
+    };
+
+    // Fullscreen triangle generated from the vertex index
+    vk::PipelineVertexInputStateCreateInfo vertexInputInfo;
+
+    vk::PipelineInputAssemblyStateCreateInfo inputAssembly {
+        .topology = vk::PrimitiveTopology::eTriangleList
+    };
+
+    vk::PipelineViewportStateCreateInfo viewportState {
+        .viewportCount = 1,
+        .scissorCount = 1
+    };
+
+    vk::PipelineRasterizationStateCreateInfo rasterizer {
+        .depthClampEnable = vk::False,
+        .rasterizerDiscardEnable = vk::False,
+        .polygonMode = vk::PolygonMode::eFill,
+        .cullMode = vk::CullModeFlagBits::eNone,
+        .frontFace = vk::FrontFace::eCounterClockwise,
+        .depthBiasEnable = vk::False,
+        .lineWidth = 1.0f
+    };
+
+    vk::PipelineMultisampleStateCreateInfo multisampling {
+        .rasterizationSamples = vk::SampleCountFlagBits::e1,
+        .sampleShadingEnable = vk::False
+    };
+
+    vk::PipelineColorBlendAttachmentState colorBlendAttachment {
+        .blendEnable = vk::False,
+        .colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
+    };
+
+    vk::PipelineColorBlendStateCreateInfo colorBlending {
+        .logicOpEnable = vk::False,
+        .logicOp = vk::LogicOp::eCopy,
+        .attachmentCount = 1,
+        .pAttachments = &colorBlendAttachment
+    };
+
+    vk::PipelineRenderingCreateInfo pipelineRenderingCreateInfo {
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &mSwapFormat.format
+    };
+
+    vk::GraphicsPipelineCreateInfo pipelineInfo {
+        .pNext = &pipelineRenderingCreateInfo,
+        .stageCount = 2,
+        .pStages = shaderStages,
+        .pVertexInputState = &vertexInputInfo,
+        .pInputAssemblyState = &inputAssembly,
+        .pViewportState = &viewportState,
+        .pRasterizationState = &rasterizer,
+        .pMultisampleState = &multisampling,
+        .pColorBlendState = &colorBlending,
+        .pDynamicState = &dynamicState,
+        .layout = mCompositePipelineLayout,
+        .renderPass = nullptr
+    };
+
+    mCompositePipeline = vk::raii::Pipeline(mDevice, mPipelineLibrary.GetPipelineCache(), pipelineInfo);
+    mCompositeFormat = mSwapFormat.format;
 }
 
 [[nodiscard]] vk::raii::ShaderModule VulkanContext::createShaderModule(const std::vector<char>& code) const {
@@ -508,51 +1080,255 @@ void VulkanContext::createGraphicsPipeline() {
     return vk::raii::ShaderModule(mDevice, smCreateInfo);
 }
 
-void VulkanContext::recordCommandBuffer(uint32_t imageIndex) {
-    auto& cmd = mCommandBuffers[mFrameIndex];
+void VulkanContext::recordSceneCommandBuffer(uint32_t frameIndex) {
+    auto& cmd = mSceneCommandBuffers[frameIndex];
+    auto& target = mSceneColorTargets[frameIndex];
+    const vk::Extent2D renderExtent = mRenderExtents[frameIndex];
 
     cmd.begin({});
 
+    if (*mTimestampQueryPool) {
+        cmd.resetQueryPool(mTimestampQueryPool, frameIndex * TimestampCount, TimestampCount);
+        cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, mTimestampQueryPool, frameIndex * TimestampCount + SceneBegin);
+    }
+
+    // Bin the lights and select the mesh clusters for this frame's camera before shading
+    mLighting->RecordCulling(cmd, frameIndex);
+    mMeshletRenderer->RecordCulling(cmd, frameIndex);
+
     TransitionImageLayout(
-        cmd, mSwapchainImages[imageIndex],
+        cmd, target.image,
         vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal,
         {}, vk::AccessFlagBits2::eColorAttachmentWrite,
         vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::PipelineStageFlagBits2::eColorAttachmentOutput
     );
 
+    TransitionImageLayout(
+        cmd, mDepthTargets[frameIndex].image,
+        vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthAttachmentOptimal,
+        vk::AccessFlagBits2::eDepthStencilAttachmentWrite, vk::AccessFlagBits2::eDepthStencilAttachmentRead | vk::AccessFlagBits2::eDepthStencilAttachmentWrite,
+        vk::PipelineStageFlagBits2::eLateFragmentTests, vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests,
+        vk::ImageAspectFlagBits::eDepth
+    );
+
     vk::ClearValue clearColor = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f);
     vk::RenderingAttachmentInfo attachmentInfo = {
-        .imageView = mSwapchainImageViews[imageIndex],
+        .imageView = target.view,
         .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
         .loadOp = vk::AttachmentLoadOp::eClear,
         .storeOp = vk::AttachmentStoreOp::eStore,
         .clearValue = clearColor
     };
 
+    vk::RenderingAttachmentInfo depthAttachmentInfo = {
+        .imageView = mDepthTargets[frameIndex].view,
+        .imageLayout = vk::ImageLayout::eDepthAttachmentOptimal,
+        .loadOp = vk::AttachmentLoadOp::eClear,
+        .storeOp = vk::AttachmentStoreOp::eDontCare,
+        .clearValue = vk::ClearDepthStencilValue(1.0f, 0)
+    };
+
     vk::RenderingInfo renderingInfo = {
-        .renderArea = {.offset = {0, 0}, .extent = mSwapExtent },
+        .renderArea = {.offset = {0, 0}, .extent = renderExtent },
         .layerCount = 1,
         .colorAttachmentCount = 1,
-        .pColorAttachments = &attachmentInfo
+        .pColorAttachments = &attachmentInfo,
+        .pDepthAttachment = &depthAttachmentInfo
     };
 
     // Drawing
     cmd.beginRendering(renderingInfo);
     
     cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, mGraphicsPipeline);
-    cmd.setViewport(0, vk::Viewport(0.0f, 0.0f, static_cast<float>(mSwapExtent.width), static_cast<float>(mSwapExtent.height)));
-    cmd.setScissor(0, vk::Rect2D(vk::Offset2D(0, 0), mSwapExtent));
+    cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, mPipelineLayout, 0, mLighting->GetDescriptorSet(frameIndex), {});
+    cmd.setViewport(0, vk::Viewport(0.0f, 0.0f, static_cast<float>(renderExtent.width), static_cast<float>(renderExtent.height)));
+    cmd.setScissor(0, vk::Rect2D(vk::Offset2D(0, 0), renderExtent));
     cmd.draw(3, 1, 0, 0);
 
+    mMeshletRenderer->RecordDraw(cmd, frameIndex, mLighting->GetDescriptorSet(frameIndex));
+
     cmd.endRendering();
 
+    // Handed to the compute queue, the semaphore signal makes the writes available there
     TransitionImageLayout(
-        cmd, mSwapchainImages[imageIndex],
-        vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::ePresentSrcKHR,
+        cmd, target.image,
+        vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eGeneral,
         vk::AccessFlagBits2::eColorAttachmentWrite, {},
         vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::PipelineStageFlagBits2::eBottomOfPipe
     );
 
+    if (*mTimestampQueryPool) {
+        cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eBottomOfPipe, mTimestampQueryPool, frameIndex * TimestampCount + SceneEnd);
+    }
+
+    cmd.end();
+}
+
+void VulkanContext::recordPostProcess(vk::raii::CommandBuffer& cmd, uint32_t frameIndex) {
+    auto& output = mPostProcessTargets[frameIndex];
+    const vk::Extent2D renderExtent = mRenderExtents[frameIndex];
+
+    if (mComputeTimestamps) {
+        cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, mTimestampQueryPool, frameIndex * TimestampCount + PostProcessBegin);
+    }
+
+    TransitionImageLayout(
+        cmd, output.image,
+        vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral,
+        {}, vk::AccessFlagBits2::eShaderStorageWrite,
+        vk::PipelineStageFlagBits2::eComputeShader, vk::PipelineStageFlagBits2::eComputeShader
+    );
+
+    const TonemapConstants constants {
+        .width = renderExtent.width,
+        .height = renderExtent.height,
+        .exposure = mExposure
+    };
+
+    mTonemapPass->Bind(cmd, frameIndex);
+    mTonemapPass->PushConstants(cmd, constants);
+
+    // Covers one texel past the render extent for the upscaling filter
+    cmd.dispatch((renderExtent.width + 8) / 8, (renderExtent.height + 8) / 8, 1);
+
+    if (mComputeTimestamps) {
+        cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eBottomOfPipe, mTimestampQueryPool, frameIndex * TimestampCount + PostProcessEnd);
+    }
+}
+
+void VulkanContext::recordCompositeCommandBuffer(uint32_t frameIndex, uint32_t imageIndex) {
+    auto& cmd = mCommandBuffers[frameIndex];
+    vk::Image source = mPostProcessTargets[frameIndex].image;
+    vk::Image swapchainImage = mSwapchainImages[imageIndex];
+    const vk::Extent2D renderExtent = mRenderExtents[frameIndex];
+
+    cmd.begin({});
+
+    if (*mTimestampQueryPool) {
+        cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, mTimestampQueryPool, frameIndex * TimestampCount + CompositeBegin);
+    }
+
+    // Where the composited swapchain image was last written
+    vk::ImageLayout layout = vk::ImageLayout::eTransferDstOptimal;
+    vk::AccessFlags2 access = vk::AccessFlagBits2::eTransferWrite;
+    vk::PipelineStageFlags2 stage = vk::PipelineStageFlagBits2::eTransfer;
+
+    if (mBlitComposite) {
+        TransitionImageLayout(
+            cmd, source,
+            vk::ImageLayout::eGeneral, vk::ImageLayout::eTransferSrcOptimal,
+            {}, vk::AccessFlagBits2::eTransferRead,
+            vk::PipelineStageFlagBits2::eTransfer, vk::PipelineStageFlagBits2::eTransfer
+        );
+
+        TransitionImageLayout(
+            cmd, swapchainImage,
+            vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+            {}, vk::AccessFlagBits2::eTransferWrite,
+            vk::PipelineStageFlagBits2::eTransfer, vk::PipelineStageFlagBits2::eTransfer
+        );
+
+        // Upscale from the render resolution to the swapchain, post-processing padded the render
+        // extent with a copy of its edge so the linear filter never reads stale texels
+        const vk::Offset3D srcExtent = { static_cast<int32_t>(renderExtent.width), static_cast<int32_t>(renderExtent.height), 1 };
+        const vk::Offset3D dstExtent = { static_cast<int32_t>(mSwapExtent.width), static_cast<int32_t>(mSwapExtent.height), 1 };
+        vk::ImageBlit blitRegion {
+            .srcSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 },
+            .srcOffsets = std::array<vk::Offset3D, 2>{ vk::Offset3D{ 0, 0, 0 }, srcExtent },
+            .dstSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 },
+            .dstOffsets = std::array<vk::Offset3D, 2>{ vk::Offset3D{ 0, 0, 0 }, dstExtent }
+        };
+        cmd.blitImage(source, vk::ImageLayout::eTransferSrcOptimal, swapchainImage, vk::ImageLayout::eTransferDstOptimal, blitRegion, vk::Filter::eLinear);
+    }
+    else {
+        // The post-processed image stays in the general layout and is sampled directly
+        TransitionImageLayout(
+            cmd, swapchainImage,
+            vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal,
+            {}, vk::AccessFlagBits2::eColorAttachmentWrite,
+            vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::PipelineStageFlagBits2::eColorAttachmentOutput
+        );
+
+        vk::RenderingAttachmentInfo attachmentInfo = {
+            .imageView = mSwapchainImageViews[imageIndex],
+            .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+            .loadOp = vk::AttachmentLoadOp::eDontCare,
+            .storeOp = vk::AttachmentStoreOp::eStore
+        };
+
+        vk::RenderingInfo renderingInfo = {
+            .renderArea = { .offset = { 0, 0 }, .extent = mSwapExtent },
+            .layerCount = 1,
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &attachmentInfo
+        };
+
+        // Upscale from the render resolution to the swapchain
+        const glm::vec2 targetSize(static_cast<float>(mSwapExtent.width), static_cast<float>(mSwapExtent.height));
+        const glm::vec2 renderSize(static_cast<float>(renderExtent.width), static_cast<float>(renderExtent.height));
+        const CompositeConstants constants {
+            .uvScale = renderSize / targetSize,
+            .uvMax = (renderSize - 0.5f) / targetSize
+        };
+
+        cmd.beginRendering(renderingInfo);
+        cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, mCompositePipeline);
+        cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, mCompositePipelineLayout, 0, *mCompositeDescriptorSets[frameIndex], {});
+        cmd.pushConstants<CompositeConstants>(mCompositePipelineLayout, vk::ShaderStageFlagBits::eFragment, 0, constants);
+        cmd.setViewport(0, vk::Viewport(0.0f, 0.0f, targetSize.x, targetSize.y));
+        cmd.setScissor(0, vk::Rect2D(vk::Offset2D(0, 0), mSwapExtent));
+        cmd.draw(3, 1, 0, 0);
+        cmd.endRendering();
+
+        layout = vk::ImageLayout::eColorAttachmentOptimal;
+        access = vk::AccessFlagBits2::eColorAttachmentWrite;
+        stage = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
+    }
+
+    if (mFrameCapture->IsCapturePending() && !mSwapchainReadback) {
+        // The post-processed image at render resolution, the composite only read it so no barrier is needed
+        mFrameCapture->RecordCopy(
+            cmd, frameIndex, source, mBlitComposite ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::eGeneral, renderExtent
+        );
+
+        TransitionImageLayout(
+            cmd, swapchainImage,
+            layout, vk::ImageLayout::ePresentSrcKHR,
+            access, {},
+            stage, vk::PipelineStageFlagBits2::eBottomOfPipe
+        );
+    }
+    else if (mFrameCapture->IsCapturePending()) {
+        // Copy the finished image into a readback buffer, collected once this frame's fence signals
+        TransitionImageLayout(
+            cmd, swapchainImage,
+            layout, vk::ImageLayout::eTransferSrcOptimal,
+            access, vk::AccessFlagBits2::eTransferRead,
+            stage, vk::PipelineStageFlagBits2::eTransfer
+        );
+
+        mFrameCapture->RecordCopy(cmd, frameIndex, swapchainImage, vk::ImageLayout::eTransferSrcOptimal, mSwapExtent);
+
+        TransitionImageLayout(
+            cmd, swapchainImage,
+            vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::ePresentSrcKHR,
+            vk::AccessFlagBits2::eTransferRead, {},
+            vk::PipelineStageFlagBits2::eTransfer, vk::PipelineStageFlagBits2::eBottomOfPipe
+        );
+    }
+    else {
+        TransitionImageLayout(
+            cmd, swapchainImage,
+            layout, vk::ImageLayout::ePresentSrcKHR,
+            access, {},
+            stage, vk::PipelineStageFlagBits2::eBottomOfPipe
+        );
+    }
+
+    if (*mTimestampQueryPool) {
+        cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eBottomOfPipe, mTimestampQueryPool, frameIndex * TimestampCount + CompositeEnd);
+    }
+
     cmd.end();
 }
 
@@ -564,11 +1340,18 @@ void VulkanContext::recreateSwapchain() {
         glfwGetFramebufferSize(mWindow, &width, &height);
     } while (width == 0 || height == 0);
 
+    if (mPendingPresent) {
+        discardFrame(mPendingFrameIndex);
+        mPendingPresent = false;
+    }
+
     mDevice.waitIdle();
     mSwapchainImageViews.clear();
     mSwapchain = nullptr;
 
     createSwapchain();
+    createCompositePass();
+    createRenderTargets();
 }
 
 }
\ No newline at end of file
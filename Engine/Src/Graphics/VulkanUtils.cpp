@@ -0,0 +1,103 @@
+#include <Graphics/VulkanUtils.h>
+
+#include <fstream>
+#include <stdexcept>
+
+namespace VE::Gfx {
+
+// -----------------------------------------------------------------------------------------------
+// Utility Functions
+// -----------------------------------------------------------------------------------------------
+std::vector<char> ReadFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file!");
+    }
+
+    std::vector<char> buffer(file.tellg());
+    file.seekg(0, std::ios::beg);
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.close();
+
+    return buffer;
+}
+
+uint32_t FindMemoryType(const vk::raii::PhysicalDevice& physicalDevice, uint32_t typeFilter, vk::MemoryPropertyFlags properties) {
+    auto memProperties = physicalDevice.getMemoryProperties();
+
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i) {
+        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+void CreateBuffer(
+    const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice,
+    vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties,
+    vk::raii::Buffer& buffer, vk::raii::DeviceMemory& bufferMemory
+) {
+    vk::BufferCreateInfo bufferInfo {
+        .size = size,
+        .usage = usage,
+        .sharingMode = vk::SharingMode::eExclusive
+    };
+    buffer = vk::raii::Buffer(device, bufferInfo);
+
+    vk::MemoryRequirements memRequirements = buffer.getMemoryRequirements();
+    vk::MemoryAllocateInfo allocInfo {
+        .allocationSize = memRequirements.size,
+        .memoryTypeIndex = FindMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties)
+    };
+    bufferMemory = vk::raii::DeviceMemory(device, allocInfo);
+
+    buffer.bindMemory(*bufferMemory, 0);
+}
+
+void CreateImage(
+    const vk::raii::Device& device, const vk::raii::PhysicalDevice& physicalDevice,
+    uint32_t width, uint32_t height, vk::Format format, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties,
+    const std::vector<uint32_t>& queueFamilies, vk::raii::Image& image, vk::raii::DeviceMemory& imageMemory
+) {
+    const bool concurrent = queueFamilies.size() > 1;
+
+    vk::ImageCreateInfo imageInfo {
+        .imageType = vk::ImageType::e2D,
+        .format = format,
+        .extent = { width, height, 1 },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = vk::SampleCountFlagBits::e1,
+        .tiling = vk::ImageTiling::eOptimal,
+        .usage = usage,
+        .sharingMode = concurrent ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = concurrent ? static_cast<uint32_t>(queueFamilies.size()) : 0,
+        .pQueueFamilyIndices = concurrent ? queueFamilies.data() : nullptr,
+        .initialLayout = vk::ImageLayout::eUndefined
+    };
+    image = vk::raii::Image(device, imageInfo);
+
+    vk::MemoryRequirements memRequirements = image.getMemoryRequirements();
+    vk::MemoryAllocateInfo allocInfo {
+        .allocationSize = memRequirements.size,
+        .memoryTypeIndex = FindMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties)
+    };
+    imageMemory = vk::raii::DeviceMemory(device, allocInfo);
+
+    image.bindMemory(*imageMemory, 0);
+}
+
+vk::raii::ImageView CreateImageView(const vk::raii::Device& device, vk::Image image, vk::Format format, vk::ImageAspectFlags aspect) {
+    vk::ImageViewCreateInfo viewInfo {
+        .image = image,
+        .viewType = vk::ImageViewType::e2D,
+        .format = format,
+        .subresourceRange = { aspect, 0, 1, 0, 1 }
+    };
+
+    return vk::raii::ImageView(device, viewInfo);
+}
+
+}
\ No newline at end of file
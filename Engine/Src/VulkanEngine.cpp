@@ -14,4 +14,64 @@ void VulkanEngine::Render() {
     mContext->Render();
 }
 
+void VulkanEngine::StartCapture(const std::filesystem::path& directory, Gfx::CaptureFormat format) {
+    mContext->GetFrameCapture().Start(directory, format);
+}
+
+void VulkanEngine::StopCapture() {
+    mContext->GetFrameCapture().Stop();
+}
+
+void VulkanEngine::Screenshot(const std::filesystem::path& path, Gfx::CaptureFormat format) {
+    mContext->GetFrameCapture().Screenshot(path, format);
+}
+
+uint64_t VulkanEngine::GetDroppedCaptureFrames() const {
+    return mContext->GetFrameCapture().GetDroppedFrameCount();
+}
+
+void VulkanEngine::SetDynamicResolution(const Gfx::DynamicResolutionSettings& settings) {
+    mContext->GetDynamicResolution().Configure(settings);
+}
+
+float VulkanEngine::GetRenderScale() const {
+    return mContext->GetDynamicResolution().GetScale();
+}
+
+float VulkanEngine::GetGpuFrameTime() const {
+    return mContext->GetGpuFrameTime();
+}
+
+const std::vector<Core::TaskTiming>& VulkanEngine::GetStartupTimings() const {
+    return mContext->GetStartupTimings();
+}
+
+const Gfx::MemoryStatistics& VulkanEngine::GetMemoryStatistics() const {
+    return mContext->GetResidencyManager().GetStatistics();
+}
+
+void VulkanEngine::SetLights(std::span<const Gfx::Light> lights) {
+    mContext->GetLighting().SetLights(lights);
+}
+
+void VulkanEngine::SetCamera(const Gfx::Camera& camera) {
+    mContext->SetCamera(camera);
+}
+
+Gfx::MeshHandle VulkanEngine::AddMesh(std::span<const Gfx::MeshVertex> vertices, std::span<const uint32_t> indices, const glm::mat4& transform) {
+    return mContext->GetMeshletRenderer().AddMesh(vertices, indices, transform);
+}
+
+void VulkanEngine::SetMeshTransform(Gfx::MeshHandle mesh, const glm::mat4& transform) {
+    mContext->GetMeshletRenderer().SetTransform(mesh, transform);
+}
+
+void VulkanEngine::SetLodErrorThreshold(float pixels) {
+    mContext->GetMeshletRenderer().SetErrorThreshold(pixels);
+}
+
+const Gfx::MeshletStatistics& VulkanEngine::GetMeshletStatistics() const {
+    return mContext->GetMeshletRenderer().GetStatistics();
+}
+
 }
\ No newline at end of file